@@ -1,34 +1,85 @@
-#include <avr/io.h> // Include AVR I/O definitions
-#include "RTC_Operations.h" // Include custom RTC operation header file
-
-/**
- * @brief Initialize the Real-Time Counter (RTC).
- * Configures the RTC module with specified settings, including clock source,
- * prescaler, interrupt setup, and enabling it to run in standby and debug modes.
- */
-void RTC_init(void)
-{
-    // Wait for all RTC registers to synchronize before making changes
-    while (RTC.STATUS > 0)
-    {
-        ; // Empty loop to ensure synchronization is complete
-    }
-    
-    // Set the period and compare values for the RTC
-    RTC.PER = RTC_PERIOD; // Set the RTC period from a predefined constant
-    RTC.CMP = RTC_CMP;    // Set the RTC compare value from a predefined constant
-    
-    // Configure RTC control register
-    RTC.CTRLA = RTC_PRESCALER_DIV1_gc // Use a prescaler value of 1 (no division)
-                 | RTC_RTCEN_bm       // Enable the RTC module
-                 | RTC_RUNSTDBY_bm;   // Allow RTC to run in standby mode
-    
-    // Select the internal 32.768 kHz clock as the RTC clock source
-    RTC.CLKSEL = RTC_CLKSEL_INT32K_gc;
-    
-    // Configure RTC to continue running during debugging
-    RTC.DBGCTRL = RTC_DBGRUN_bm;
-    
-    // Enable the Overflow Interrupt to trigger an interrupt on RTC overflow
-    RTC.INTCTRL |= RTC_OVF_bm;
-}
+#include <avr/io.h> // Include AVR I/O definitions
+#include <avr/interrupt.h>
+#include "RTC_Operations.h" // Include custom RTC operation header file
+
+// Number of RTC overflows since initialization
+volatile uint32_t rtcOverflows = 0;
+
+// Worst-case RTC ISR run time in CPU cycles
+volatile uint16_t rtcIsrMaxCycles = 0;
+
+/**
+ * @brief Initialize the Real-Time Counter (RTC).
+ * Configures the RTC module with specified settings, including clock source,
+ * prescaler, interrupt setup, and enabling it to run in standby and debug modes.
+ */
+void RTC_init(void)
+{
+    // Wait for all RTC registers to synchronize before making changes
+    while (RTC.STATUS > 0)
+    {
+        ; // Empty loop to ensure synchronization is complete
+    }
+    
+    // Set the period and compare values for the RTC
+    RTC.PER = RTC_PERIOD; // Set the RTC period from a predefined constant
+    RTC.CMP = RTC_CMP;    // Set the RTC compare value from a predefined constant
+    
+    // Configure RTC control register
+    RTC.CTRLA = RTC_PRESCALER_DIV1_gc // Use a prescaler value of 1 (no division)
+                 | RTC_RTCEN_bm       // Enable the RTC module
+                 | RTC_RUNSTDBY_bm;   // Allow RTC to run in standby mode
+    
+    // Select the internal 32.768 kHz clock as the RTC clock source
+    RTC.CLKSEL = RTC_CLKSEL_INT32K_gc;
+    
+    // Configure RTC to continue running during debugging
+    RTC.DBGCTRL = RTC_DBGRUN_bm;
+    
+    // Enable the Overflow Interrupt to trigger an interrupt on RTC overflow
+    RTC.INTCTRL |= RTC_OVF_bm;
+}
+
+/**
+ * @brief Returns the time since RTC_init() in milliseconds.
+ * Combines the overflow count with the current counter value, accounting for
+ * an overflow that has happened but not yet been serviced. The counter runs
+ * at 32.768 kHz, so no extra periodic interrupt is needed for millisecond
+ * resolution. Safe to call from any context, including the RTC ISR once it
+ * has cleared its flag.
+ *
+ * @return Uptime in milliseconds, wraps after ~49.7 days.
+ */
+uint32_t RTC_getMillis(void)
+{
+    uint32_t overflows;
+    uint16_t count;
+    uint8_t sreg = SREG;
+    
+    cli(); // Read the overflow count and counter as one snapshot
+    overflows = rtcOverflows;
+    count = RTC.CNT;
+    
+    // The counter wrapped but the overflow ISR has not run yet
+    if (RTC.INTFLAGS & RTC_OVF_bm)
+    {
+        overflows++;
+        count = RTC.CNT;
+    }
+    SREG = sreg;
+    
+    // 32768 counts per second: ms = count * 1000 / 32768
+    return (uint32_t)overflows * RTC_MS_PER_OVERFLOW + (((uint32_t)count * 125) >> 12);
+}
+
+/**
+ * @brief Starts TCB1 as a free-running CPU cycle counter for ISR profiling.
+ * In periodic interrupt mode with the maximum period and no interrupt
+ * enabled, CNT simply counts CPU cycles and wraps every 65536 cycles.
+ */
+void RTC_profileInit(void)
+{
+    TCB1.CCMP = 0xFFFF;
+    TCB1.CTRLB = TCB_CNTMODE_INT_gc;
+    TCB1.CTRLA = TCB_CLKSEL_CLKDIV1_gc | TCB_ENABLE_bm;
+}
@@ -1,25 +1,56 @@
-/* 
- * File:   RTC_Operations.h
- * Author: chris
- *
- * Created on October 21, 2024, 5:50 PM
- */
-
-#ifndef RTC_OPERATIONS_H
-#define	RTC_OPERATIONS_H
-
-#include <avr/io.h>
-
-#ifndef RTC_PERIOD
-#define RTC_PERIOD 16383
-#endif
-
-#ifndef RTC_CMP
-#define RTC_CMP 32766
-#endif
-
-//Functions
-void RTC_init(void);
-
-#endif	/* RTC_OPERATIONS_H */
-
+/* 
+ * File:   RTC_Operations.h
+ * Author: chris
+ *
+ * Created on October 21, 2024, 5:50 PM
+ */
+
+#ifndef RTC_OPERATIONS_H
+#define	RTC_OPERATIONS_H
+
+#include <avr/io.h>
+#include <stdint.h>
+
+#ifndef RTC_PERIOD
+#define RTC_PERIOD 16383
+#endif
+
+#ifndef RTC_CMP
+#define RTC_CMP 32766
+#endif
+
+// Milliseconds per RTC overflow (32.768 kHz clock)
+#define RTC_MS_PER_OVERFLOW (((uint32_t)RTC_PERIOD + 1) * 1000 / 32768)
+
+// Overflow count, incremented by the RTC overflow ISR. 32 bits so the
+// millisecond uptime built from it only wraps after ~49.7 days.
+extern volatile uint32_t rtcOverflows;
+
+// Longest RTC ISR run time seen, in CPU cycles (measured with TCB1)
+extern volatile uint16_t rtcIsrMaxCycles;
+
+// Bracket the RTC ISR body to record its worst-case run time
+#define RTC_PROFILE_START() uint16_t _profileStart = TCB1.CNT
+#define RTC_PROFILE_END() do { \
+        uint16_t _profileCycles = TCB1.CNT - _profileStart; \
+        if (_profileCycles > rtcIsrMaxCycles) rtcIsrMaxCycles = _profileCycles; \
+    } while (0)
+
+//Functions
+void RTC_init(void);
+uint32_t RTC_getMillis(void);
+void RTC_profileInit(void);
+
+// Deadline helpers, correct across the wrap of the millisecond uptime
+static inline uint8_t RTC_timeReached(uint32_t now, uint32_t deadline) {
+    return (int32_t)(now - deadline) >= 0;
+}
+static inline uint8_t RTC_deadlinePassed(uint32_t deadline) {
+    return RTC_timeReached(RTC_getMillis(), deadline);
+}
+static inline uint32_t RTC_elapsed(uint32_t since) {
+    return RTC_getMillis() - since;
+}
+
+#endif	/* RTC_OPERATIONS_H */
+
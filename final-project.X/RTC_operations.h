@@ -1,39 +1,103 @@
-/* 
- * File:   RTC_Operations.h
- * Author: chris
- *
- * Description:
- * Header file for Real-Time Counter (RTC) operations.
- * It defines constants and declares the initialization function for the RTC module.
- *
- * Created on October 21, 2024, 5:50 PM
- */
-
-#ifndef RTC_OPERATIONS_H
-#define RTC_OPERATIONS_H
-
-#include <avr/io.h> // Include AVR I/O definitions to access registers and constants
-
-// Default RTC period value
-// Defines the maximum count value before the RTC overflows. 
-// This determines the overflow interval based on the clock frequency.
-#ifndef RTC_PERIOD
-#define RTC_PERIOD 16383
-#endif
-
-// Default RTC compare value
-// Used to trigger a specific event when the counter reaches this value.
-// Should be less than or equal to RTC_PERIOD.
-#ifndef RTC_CMP
-#define RTC_CMP 32766
-#endif
-
-
-/**
- * @brief Initializes the RTC module.
- * Configures the RTC with specific period, compare, and control settings, enabling
- * interrupts and selecting the clock source.
- */
-void RTC_init(void);
-
-#endif /* RTC_OPERATIONS_H */
+/* 
+ * File:   RTC_Operations.h
+ * Author: chris
+ *
+ * Description:
+ * Header file for Real-Time Counter (RTC) operations.
+ * It defines constants and declares the initialization function for the RTC module.
+ *
+ * Created on October 21, 2024, 5:50 PM
+ */
+
+#ifndef RTC_OPERATIONS_H
+#define RTC_OPERATIONS_H
+
+#include <avr/io.h> // Include AVR I/O definitions to access registers and constants
+#include <stdint.h>
+
+// Default RTC period value
+// Defines the maximum count value before the RTC overflows. 
+// This determines the overflow interval based on the clock frequency.
+#ifndef RTC_PERIOD
+#define RTC_PERIOD 16383
+#endif
+
+// Default RTC compare value
+// Used to trigger a specific event when the counter reaches this value.
+// Should be less than or equal to RTC_PERIOD.
+#ifndef RTC_CMP
+#define RTC_CMP 32766
+#endif
+
+// Milliseconds per RTC overflow (32.768 kHz clock)
+#define RTC_MS_PER_OVERFLOW (((uint32_t)RTC_PERIOD + 1) * 1000 / 32768)
+
+// Overflow count, incremented by the RTC overflow ISR. 32 bits so the
+// millisecond uptime built from it only wraps after ~49.7 days.
+extern volatile uint32_t rtcOverflows;
+
+// Longest RTC ISR run time seen, in CPU cycles (measured with TCB1)
+extern volatile uint16_t rtcIsrMaxCycles;
+
+// Bracket the RTC ISR body to record its worst-case run time
+#define RTC_PROFILE_START() uint16_t _profileStart = TCB1.CNT
+#define RTC_PROFILE_END() do { \
+        uint16_t _profileCycles = TCB1.CNT - _profileStart; \
+        if (_profileCycles > rtcIsrMaxCycles) rtcIsrMaxCycles = _profileCycles; \
+    } while (0)
+
+/**
+ * @brief Initializes the RTC module.
+ * Configures the RTC with specific period, compare, and control settings, enabling
+ * interrupts and selecting the clock source.
+ */
+void RTC_init(void);
+
+/**
+ * @brief Returns the time since RTC_init() in milliseconds.
+ * Combines the overflow count with the current counter value, accounting for
+ * an overflow that has happened but not yet been serviced.
+ *
+ * @return Uptime in milliseconds.
+ */
+uint32_t RTC_getMillis(void);
+
+/**
+ * @brief Starts TCB1 as a free-running CPU cycle counter for ISR profiling.
+ */
+void RTC_profileInit(void);
+
+/**
+ * @brief Checks whether a deadline has been reached.
+ * Correct across the wrap of the millisecond uptime as long as the deadline
+ * is less than ~24 days away.
+ *
+ * @param now Current time in milliseconds.
+ * @param deadline Deadline in milliseconds.
+ * @return 1 if now is at or past the deadline.
+ */
+static inline uint8_t RTC_timeReached(uint32_t now, uint32_t deadline) {
+    return (int32_t)(now - deadline) >= 0;
+}
+
+/**
+ * @brief Checks whether a deadline has passed, using the current uptime.
+ *
+ * @param deadline Deadline in milliseconds.
+ * @return 1 if the deadline has been reached.
+ */
+static inline uint8_t RTC_deadlinePassed(uint32_t deadline) {
+    return RTC_timeReached(RTC_getMillis(), deadline);
+}
+
+/**
+ * @brief Milliseconds elapsed since a timestamp.
+ *
+ * @param since Earlier RTC_getMillis() value.
+ * @return Elapsed time in milliseconds.
+ */
+static inline uint32_t RTC_elapsed(uint32_t since) {
+    return RTC_getMillis() - since;
+}
+
+#endif /* RTC_OPERATIONS_H */
@@ -1,23 +1,23 @@
-/* 
- * File:   USART_init.h
- * Author: chris
- *
- * Created on November 24, 2024, 9:41 PM
- */
-
-#ifndef USART_INIT_H
-#define	USART_INIT_H
-
-#ifdef	__cplusplus
-extern "C" {
-#endif
-
-
-
-
-#ifdef	__cplusplus
-}
-#endif
-
-#endif	/* USART_INIT_H */
-
+/* 
+ * File:   USART_init.h
+ * Author: chris
+ *
+ * Created on November 24, 2024, 9:41 PM
+ */
+
+#ifndef USART_INIT_H
+#define	USART_INIT_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+
+
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* USART_INIT_H */
+
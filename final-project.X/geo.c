@@ -0,0 +1,175 @@
+/*
+ * File:   geo.c
+ * Author: chehj
+ *
+ * Created on December 9, 2024, 3:45 PM
+ */
+
+#include "geo.h"
+
+// atan(k / 16) in 0.01 degrees for k = 0..16
+static const uint16_t atanTable[17] = {
+    0, 358, 713, 1062, 1404, 1735, 2056, 2363, 2657,
+    2936, 3201, 3451, 3687, 3909, 4119, 4315, 4500
+};
+
+
+/**
+ * @brief Multiplies a coordinate offset by a Q16 scale without 64-bit math.
+ * The scale is split into its high and low bytes so both partial products
+ * fit in 32 bits for offsets up to GEO_MAX_OFFSET.
+ *
+ * @param offset Coordinate offset (1e-7 degrees).
+ * @param scale Centimetres per unit, Q16.
+ * @return offset * scale / 65536, in cm.
+ */
+static int32_t geo_scale(int32_t offset, uint32_t scale) {
+    int32_t high = offset * (int32_t)(scale >> 8);
+    int32_t low = (offset * (int32_t)(scale & 0xFF)) >> 8;
+    
+    return (high + low) >> 8;
+}
+
+/**
+ * @brief Anchors the local frame at a position.
+ * Evaluates cos(latitude) once; every later projection is integer only.
+ *
+ * @param origin Frame to initialize.
+ * @param lat Origin latitude (1e-7 degrees).
+ * @param lon Origin longitude (1e-7 degrees).
+ */
+void geo_set_origin(geo_origin_t *origin, gps_coord_t lat, gps_coord_t lon) {
+    origin->lat = lat;
+    origin->lon = lon;
+    origin->eastScale = (uint32_t)(GEO_CM_PER_UNIT_Q16 * cos(degrees_to_radians(lat / (double)GPS_COORD_SCALE)) + 0.5);
+}
+
+/**
+ * @brief Projects a position into the local frame.
+ *
+ * @param origin Frame anchor.
+ * @param lat Latitude (1e-7 degrees).
+ * @param lon Longitude (1e-7 degrees).
+ * @param[out] point Projected position.
+ * @return 1 on success, 0 if the position is too far from the origin.
+ */
+uint8_t geo_project(const geo_origin_t *origin, gps_coord_t lat, gps_coord_t lon, geo_point_t *point) {
+    int32_t dLat = lat - origin->lat;
+    int32_t dLon = lon - origin->lon;
+    
+    if (dLat > GEO_MAX_OFFSET || dLat < -GEO_MAX_OFFSET ||
+        dLon > GEO_MAX_OFFSET || dLon < -GEO_MAX_OFFSET) {
+        return 0;
+    }
+    
+    point->north = geo_scale(dLat, GEO_CM_PER_UNIT_Q16);
+    point->east = geo_scale(dLon, origin->eastScale);
+    return 1;
+}
+
+/**
+ * @brief Integer square root.
+ * Bit-by-bit method, 16 iterations of shifts and adds.
+ *
+ * @param value Value to take the root of.
+ * @return floor(sqrt(value)).
+ */
+uint16_t geo_sqrt(uint32_t value) {
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+    
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint16_t)root;
+}
+
+/**
+ * @brief Straight-line distance between two projected points.
+ * Components are scaled down until the sum of squares fits in 32 bits, so
+ * short legs are exact to the centimetre and long legs lose only low bits.
+ *
+ * @param from Start point.
+ * @param to End point.
+ * @return Distance in cm.
+ */
+uint32_t geo_distance(const geo_point_t *from, const geo_point_t *to) {
+    int32_t dx = to->east - from->east;
+    int32_t dy = to->north - from->north;
+    uint32_t ax = (dx < 0) ? -(uint32_t)dx : (uint32_t)dx;
+    uint32_t ay = (dy < 0) ? -(uint32_t)dy : (uint32_t)dy;
+    uint8_t shift = 0;
+    
+    // Each component below 2^15 keeps the sum of squares below 2^31
+    while (ax >= 32768UL || ay >= 32768UL) {
+        ax >>= 1;
+        ay >>= 1;
+        shift++;
+    }
+    
+    return (uint32_t)geo_sqrt(ax * ax + ay * ay) << shift;
+}
+
+/**
+ * @brief Integer atan2.
+ * Reduces to the first octant and interpolates a 17-entry atan table, which
+ * is accurate to about 0.02 degrees.
+ *
+ * @param y Opposite side.
+ * @param x Adjacent side.
+ * @return Angle in 0.01 degrees from the positive x axis towards y (0 - 35999).
+ */
+uint16_t geo_atan2(int32_t y, int32_t x) {
+    uint32_t ax = (x < 0) ? -(uint32_t)x : (uint32_t)x;
+    uint32_t ay = (y < 0) ? -(uint32_t)y : (uint32_t)y;
+    uint32_t small = (ax < ay) ? ax : ay;
+    uint32_t large = (ax < ay) ? ay : ax;
+    uint16_t ratio;
+    uint16_t angle;
+    uint8_t index;
+    
+    if (large == 0) {
+        return 0;
+    }
+    
+    // Keep the ratio calculation in 32 bits
+    while (large >= (1UL << 20)) {
+        large >>= 1;
+        small >>= 1;
+    }
+    
+    // ratio = small / large in Q12, split into table index and fraction
+    ratio = (uint16_t)((small << 12) / large);
+    index = ratio >> 8;
+    angle = atanTable[index];
+    if (index < 16) {
+        angle += ((uint32_t)(atanTable[index + 1] - atanTable[index]) * (ratio & 0xFF)) >> 8;
+    }
+    
+    // Undo the octant reduction
+    if (ay > ax) angle = 9000 - angle;
+    if (x < 0) angle = 18000 - angle;
+    if (y < 0) angle = (36000 - angle) % 36000;
+    return angle;
+}
+
+/**
+ * @brief Bearing from one projected point to another.
+ *
+ * @param from Start point.
+ * @param to End point.
+ * @return Bearing in 0.01 degrees clockwise from north (0 - 35999).
+ */
+uint16_t geo_bearing(const geo_point_t *from, const geo_point_t *to) {
+    // Clockwise from north is atan2 with east as y and north as x
+    return geo_atan2(to->east - from->east, to->north - from->north);
+}
@@ -0,0 +1,101 @@
+/*
+ * File:   geo.h
+ * Author: chehj
+ *
+ * Description:
+ * Local tangent-plane geometry. Positions are projected into an east/north
+ * frame in centimetres anchored at the route origin, so distance and
+ * bearing over walking-scale legs need only integer multiply-adds instead of
+ * the floating-point haversine formula.
+ *
+ * Created on December 9, 2024, 3:45 PM
+ */
+
+#ifndef GEO_H
+#define GEO_H
+
+#include <stdint.h>
+#include "gps.h"
+
+// Centimetres per 1e-7 degree of latitude, Q16 (1.1119493 * 65536)
+#define GEO_CM_PER_UNIT_Q16 72873UL
+
+// Legs longer than this fall back to the haversine formula (cm)
+#ifndef GEO_PLANE_MAX_CM
+#define GEO_PLANE_MAX_CM 500000L
+#endif
+
+// Largest coordinate offset the projection accepts (1e-7 degrees, ~80 km)
+#define GEO_MAX_OFFSET 7000000L
+
+// Projection anchor
+typedef struct {
+    gps_coord_t lat;            // Origin latitude (1e-7 degrees)
+    gps_coord_t lon;            // Origin longitude (1e-7 degrees)
+    uint32_t eastScale;         // Centimetres per 1e-7 degree of longitude, Q16
+} geo_origin_t;
+
+// Position in the local frame
+typedef struct {
+    int32_t east;               // cm east of the origin
+    int32_t north;              // cm north of the origin
+} geo_point_t;
+
+
+/**
+ * @brief Anchors the local frame at a position.
+ * Evaluates cos(latitude) once; every later projection is integer only.
+ *
+ * @param origin Frame to initialize.
+ * @param lat Origin latitude (1e-7 degrees).
+ * @param lon Origin longitude (1e-7 degrees).
+ */
+void geo_set_origin(geo_origin_t *origin, gps_coord_t lat, gps_coord_t lon);
+
+/**
+ * @brief Projects a position into the local frame.
+ *
+ * @param origin Frame anchor.
+ * @param lat Latitude (1e-7 degrees).
+ * @param lon Longitude (1e-7 degrees).
+ * @param[out] point Projected position.
+ * @return 1 on success, 0 if the position is too far from the origin.
+ */
+uint8_t geo_project(const geo_origin_t *origin, gps_coord_t lat, gps_coord_t lon, geo_point_t *point);
+
+/**
+ * @brief Straight-line distance between two projected points.
+ *
+ * @param from Start point.
+ * @param to End point.
+ * @return Distance in cm.
+ */
+uint32_t geo_distance(const geo_point_t *from, const geo_point_t *to);
+
+/**
+ * @brief Bearing from one projected point to another.
+ *
+ * @param from Start point.
+ * @param to End point.
+ * @return Bearing in 0.01 degrees clockwise from north (0 - 35999).
+ */
+uint16_t geo_bearing(const geo_point_t *from, const geo_point_t *to);
+
+/**
+ * @brief Integer square root.
+ *
+ * @param value Value to take the root of.
+ * @return floor(sqrt(value)).
+ */
+uint16_t geo_sqrt(uint32_t value);
+
+/**
+ * @brief Integer atan2.
+ *
+ * @param y Opposite side.
+ * @param x Adjacent side.
+ * @return Angle in 0.01 degrees from the positive x axis towards y (0 - 35999).
+ */
+uint16_t geo_atan2(int32_t y, int32_t x);
+
+#endif /* GEO_H */
@@ -1,240 +1,1147 @@
-#include "gps.h"
-#include "i2c.h"
-#include "printf.h"
-
-
-// GPS Buffers
-volatile uint8_t gpsData[MAX_PACKET_SIZE]; // Buffer for raw GPS data
-volatile uint8_t _head = 0, _tail = 0;     // Circular buffer pointers
-char gps_sentence[MAX_PACKET_SIZE];        // Buffer for a complete GPS sentence
-uint16_t buffer_index = 0;  // Index to track gps_sentence
-double previous_distance = -1.0; // To calculate difference in updated distance 
-
-
-// Initialize GPS and peripherals
-void GPS_init(void) {
-    _head = 0;
-    _tail = 0;
-    TWI_init();    // Initialize I2C
-    USART2_INIT(); // Initialize UART for debugging
-}
-
-
-/**
- * @brief Converts NMEA coordinates from degree minutes to decimal degrees format.
- * 
- * @param coord The NMEA coordinate string (e.g., "12345.678").
- * @param direction The direction indicator ('N', 'S', 'E', or 'W').
- * @return The coordinate in decimal degrees format.
- */
-double convert_to_decimal(const char *coord, char direction) {
-    double raw = atof(coord);  // Convert the coordinate string to a float
-    int degrees = (int)(raw / 100);  // Get the degrees part
-    double minutes = raw - (degrees * 100);  // Get the minutes part
-    double decimal = degrees + (minutes / 60.0);  // Convert to decimal degrees
-    if (direction == 'S' || direction == 'W') {
-        decimal = -decimal;  // If South or West, make the value negative
-    }
-    return decimal;
-}
-
-/**
- * @brief Converts a time string from NMEA format (hhmmss.sss) to a 24-hour format (hh:mm:ss.sss).
- * 
- * @param time_str The time string to convert.
- * @return The time string in 24-hour format.
- */
-char* convert_to_24hr_format(const char *time_str) {
-    static char formatted_time[20];  // Buffer for formatted time string
-
-    int hours, minutes;
-    float seconds;
-
-    // Parse the time string into hours, minutes, and seconds
-    if (sscanf(time_str, "%2d%2d%f", &hours, &minutes, &seconds) != 3) {
-        return "Invalid time format";  
-    }
-
-    // Check for valid hour, minute, and second values
-    if (hours < 0 || hours >= 24 || minutes < 0 || minutes >= 60 || seconds < 0 || seconds >= 60) {
-        return "Invalid time values";  
-    }
-
-    // Format the time as a 24-hour string
-    snprintf(formatted_time, sizeof(formatted_time), "%02d:%02d:%.3f", hours, minutes, seconds);
-
-    return formatted_time;
-}
-
-
-// Function to convert degrees to radians
-double degrees_to_radians(double degrees) {
-    return degrees * M_PI / 180.0;
-}
-
-// Function to calculate the distance between two GPS coordinates
-double calc_distance(double lat1, double lon1, double lat2, double lon2) {
-    // Convert latitude and longitude from degrees to radians
-    double lat1_rad = degrees_to_radians(lat1);
-    double lon1_rad = degrees_to_radians(lon1);
-    double lat2_rad = degrees_to_radians(lat2);
-    double lon2_rad = degrees_to_radians(lon2);
-
-    // Differences in coordinates
-    double delta_lat = lat2_rad - lat1_rad;
-    double delta_lon = lon2_rad - lon1_rad;
-
-    // Haversine formula
-    double a = sin(delta_lat / 2) * sin(delta_lat / 2) +
-               cos(lat1_rad) * cos(lat2_rad) *
-               sin(delta_lon / 2) * sin(delta_lon / 2);
-    double c = 2 * atan2(sqrt(a), sqrt(1 - a));
-
-    // Distance in meters
-    return EARTH_RADIUS * c;
-}
-
-/**
- * @brief Checks if the current location is near the destination and prints status updates.
- * 
- * This function compares the current GPS coordinates with a predefined destination's coordinates.
- * It prints the current status, whether the user is approaching, arrived, or still away from the destination.
- * 
- * @param curr_lat Current latitude in decimal degrees.
- * @param curr_lon Current longitude in decimal degrees.
- */
-void check_arrival(double curr_lat, double curr_lon) {
-    // Define destination coordinates 
-    // Curret destination: Platonic Figure by UMN ME Building
-    double dest_lat = 44.974796;
-    double dest_lon = -93.233444;
-    
-    // Calculate the distance to the destination
-    double distance = calc_distance(curr_lat, curr_lon, dest_lat, dest_lon);
-
-    // Print current and destination coordinates
-    USART2_PRINTF("----------------------------------------------\r\n");
-    USART2_PRINTF("-------------Destination Location-------------\r\n");
-    USART2_PRINTF("----------------------------------------------\r\n");
-    USART2_PRINTF_MOD("%.8f, %.8f\r\n", dest_lat, dest_lon);
-    USART2_PRINTF("-----------------------------------------------\r\n");
-    USART2_PRINTF("-----------Distance From Destination-----------\r\n");
-    USART2_PRINTF("-----------------------------------------------\r\n");
-    USART2_PRINTF_MOD("%.8f m\r\n", distance);
-    if (!(statesActive & PULSE_ARRIVED )) {
-    // Check if the user is getting closer to the destination
-    if (previous_distance > 0 && distance < previous_distance) {
-        statesActive |= PULSE_DEST_CLOSER;
-        statesActive &= ~PULSE_DEST_FARTHER;
-        USART2_PRINTF("You're getting closer to your destination.\r\n");
-    } else if (previous_distance > 0) {
-        statesActive |= PULSE_DEST_FARTHER;
-        statesActive &= ~PULSE_DEST_CLOSER;
-        USART2_PRINTF("You're moving away from the destination.\r\n");
-    }
-    }
-
-    // Print arrival status
-    USART2_PRINTF("-----------------------------------------------\r\n");
-    USART2_PRINTF("--------------------STATUS---------------------\r\n");
-    USART2_PRINTF("-----------------------------------------------\r\n");
-
-    // Define arrival thresholds (e.g., 50 meters)
-    if (distance <= GPS_THRESHOLD) {
-        statesActive |= PULSE_ARRIVED;
-        statesActive &= ~PULSE_DEST_FARTHER;
-        statesActive &= ~PULSE_DEST_CLOSER;
-        USART2_PRINTF("You have arrived at your destination!\r\n");
-    } else {
-        USART2_PRINTF("Not yet at the destination. Keep going.\r\n");
-        statesActive &= ~PULSE_ARRIVED;
-    }
-
-    // Update the previous distance for the next comparison
-    previous_distance = distance;
-
-    USART2_PRINTF("\r\n");
-    USART2_PRINTF("===================================================\r\n");
-}
-
-
-
-/**
- * @brief Parses a GPGGA sentence from the GPS data.
- * 
- * This function checks if the sentence starts with "$GNGGA" and, if so, extracts the time, latitude, longitude,
- * and direction information. It then converts the latitude and longitude to decimal format, compares the current
- * position with a predefined destination, and prints the parsed data.
- * 
- * @param sentence The GPGGA sentence to be parsed.
- */
-void parse_gngga(const char *sentence) {
-    // Check if the sentence starts with "$GNGGA" 
-    if (strncmp(sentence, "$GNGGA", 6) != 0) {
-        return; // Not a GPGGA sentence, exit the function
-    }
-    
-    // Create a copy of the sentence to avoid modifying the original sentence
-    char copy[100]; 
-    strncpy(copy, sentence, sizeof(copy));
-    copy[sizeof(copy) - 1] = '\0'; // Null-terminate the string to ensure proper handling
-
-    // Tokenize the sentence to extract relevant fields (time, latitude, longitude, etc.)
-    char *token = strtok(copy, ",");
-    
-    // Parse individual fields from the sentence
-    char *time = strtok(NULL, ",");
-    char *latitude = strtok(NULL, ",");
-    char *lat_dir = strtok(NULL, ",");
-    char *longitude = strtok(NULL, ",");
-    char *lon_dir = strtok(NULL, ",");
-
-    // Convert latitude and longitude to decimal format
-    double lat_decimal = convert_to_decimal(latitude, lat_dir[0]);
-    double lon_decimal = convert_to_decimal(longitude, lon_dir[0]);
-    
-    // Check if the destination is reached based on current coordinates
-    check_arrival(lat_decimal, lon_decimal);
-
-    // Print the parsed data (time, latitude, longitude) for debugging
-    USART2_PRINTF_MOD("Time: %s\r\n", convert_to_24hr_format(time));
-    USART2_PRINTF_MOD("Latitude: %.6f %c\r\n", lat_decimal, lat_dir[0]);
-    USART2_PRINTF_MOD("Longitude: %.6f %c\r\n", lon_decimal, lon_dir[0]);
-}
-
-
-// Check and parse GPS sentences
-void parse_gps_data(void) {
-    if (!gps_data_ready) return; // No new data
-
-    while (_tail != _head) { // Process all available data
-        uint8_t incoming = gpsData[_tail++];
-        _tail %= MAX_PACKET_SIZE; // Wrap tail index
-
-        if (incoming == '$') { // Start of a new sentence
-            buffer_index = 0;
-        }
-
-        // Store byte in sentence buffer
-        if (buffer_index < MAX_PACKET_SIZE - 1) {
-            gps_sentence[buffer_index++] = incoming;
-
-            // Check for end of sentence
-            if (incoming == '\n' || incoming == '\r') {
-                gps_sentence[buffer_index] = '\0'; // Null-terminate string
-
-                // Process GNGGA sentences
-                if (strstr(gps_sentence, "GNGGA") != NULL) {
-                    USART2_PRINTF_MOD("\n");
-                    parse_gngga(gps_sentence);
-                }
-
-                buffer_index = 0; // Reset for next sentence
-            }
-        }
-    }
-
-    gps_data_ready = false; // Reset data-ready flag
-}
-
-
+#include "gps.h"
+#include "i2c.h"
+#include "printf.h"
+#include "geo.h"
+#include "route.h"
+#include "guidance.h"
+#include "track.h"
+#include "ring.h"
+
+
+// GPS Buffers
+// Each chunk is read into gpsChunk and appended to the intake ring by the TWI
+// interrupt; the parser drains the ring from the main loop
+static uint8_t gpsChunk[GPS_CHUNK_SIZE];
+static uint8_t gpsStorage[GPS_RING_SIZE];
+static ring_t gpsRing;
+static uint8_t gpsEventStorage[GPS_EVENT_QUEUE_SIZE];
+static event_queue_t gpsEvents;             // GPS_EVENT_* from the TWI interrupt
+static uint32_t gpsReadyTime = 0;           // When the last burst with data came off the bus (ms)
+static twi_transaction_t gpsRead;           // Chunk read currently on the bus
+static volatile uint8_t gpsChunks = 0;      // Chunks completed in the current burst
+static bool gpsBurstActive = false;         // Set when a burst starts, cleared by its GPS_EVENT_*
+static uint32_t gpsBurstDeadline = 0;       // RTC_getMillis() time the current burst must end by
+static volatile uint8_t gpsFillerRun = 0;   // Consecutive 0x0A bytes at the end of the burst so far
+static volatile uint16_t gpsBurstUseful = 0; // Non-filler bytes in the current burst
+static uint32_t gpsNextPoll = 0;            // RTC_getMillis() time of the next burst
+uint16_t gpsPollInterval = GPS_POLL_BASE_MS;
+uint32_t gpsBytesRead = 0;
+uint32_t gpsUsefulBytes = 0;
+uint16_t gpsBurstTimeouts = 0;
+
+// Streaming NMEA lexer and the sentence types it decodes
+static void nav_begin(void);
+static void gga_field(uint8_t index, const char *text, uint8_t length);
+static void gga_commit(void);
+static void rmc_field(uint8_t index, const char *text, uint8_t length);
+static void rmc_commit(void);
+static void vtg_field(uint8_t index, const char *text, uint8_t length);
+static void vtg_commit(void);
+static void gsa_field(uint8_t index, const char *text, uint8_t length);
+static void gsa_commit(void);
+static void pmtk_ack_field(uint8_t index, const char *text, uint8_t length);
+static void pmtk_ack_commit(void);
+static const nmea_handler_t gpsHandlers[] = {
+    { "RMC", nav_begin, rmc_field, rmc_commit },
+    { "VTG", nav_begin, vtg_field, vtg_commit },
+    { "GGA", nav_begin, gga_field, gga_commit },
+    { "GSA", nav_begin, gsa_field, gsa_commit },
+    { "PMTK001", 0, pmtk_ack_field, pmtk_ack_commit },
+};
+nmea_lexer_t gpsLexer;
+gps_fix_t gpsFix;
+
+// Fields of the sentence currently being lexed
+#define NAV_HAS_TIME 0x0001
+#define NAV_HAS_LAT 0x0002
+#define NAV_HAS_LAT_DIR 0x0004
+#define NAV_HAS_LON 0x0008
+#define NAV_HAS_LON_DIR 0x0010
+#define NAV_HAS_SPEED 0x0020
+#define NAV_HAS_COURSE 0x0040
+#define NAV_HAS_FIX_TYPE 0x0080
+#define NAV_HAS_PDOP 0x0100
+#define NAV_HAS_HDOP 0x0200
+#define NAV_HAS_VDOP 0x0400
+#define NAV_NO_FIX 0x0800           // Status or mode field reports no fix
+#define NAV_HAS_QUALITY 0x1000
+#define NAV_HAS_SATELLITES 0x2000
+#define NAV_HAS_POSITION (NAV_HAS_LAT | NAV_HAS_LAT_DIR | NAV_HAS_LON | NAV_HAS_LON_DIR)
+#define NAV_HAS_DOP (NAV_HAS_PDOP | NAV_HAS_HDOP | NAV_HAS_VDOP)
+
+// Last PMTK001 acknowledgement
+static struct {
+    uint16_t command;       // Command being acknowledged
+    uint8_t flag;           // PMTK_ACK_* value
+    volatile bool received; // Set by pmtk_ack_commit()
+    uint16_t pendingCommand;
+    uint8_t pendingFlag;
+} pmtkAck;
+
+// Only one sentence is lexed at a time, so all types share one scratch fix
+static struct {
+    uint32_t time;          // hhmmss * 1000 + milliseconds
+    gps_coord_t latitude;   // 1e-7 degrees
+    gps_coord_t longitude;  // 1e-7 degrees
+    uint16_t speed;         // cm/s
+    uint16_t course;        // 0.01 degrees
+    uint16_t pdop;          // DOP * 100
+    uint16_t hdop;
+    uint16_t vdop;
+    uint8_t fixType;        // GPS_FIX_* value
+    uint8_t quality;        // GPS_QUALITY_* value
+    uint8_t satellites;     // Satellites used
+    uint16_t fields;        // NAV_* bits of the fields received
+} navPending;
+
+// Where the motion sentences stand relative to the GGA of their epoch
+#define NAV_EPOCH_REJECTED 0    // Last GGA failed the gate, its motion is dropped
+#define NAV_EPOCH_PASSED 1      // Last GGA passed, motion of its epoch applies at once
+#define NAV_EPOCH_WAITING 2     // An RMC started a newer epoch, motion waits for its GGA
+
+// Speed and course held until the GGA of their epoch has been gated
+static struct {
+    uint32_t time;          // RMC time of the epoch
+    uint16_t speed;         // cm/s
+    uint16_t course;        // 0.01 degrees
+    uint16_t fields;        // NAV_HAS_TIME, NAV_HAS_SPEED and NAV_HAS_COURSE
+} navHeld;
+static uint32_t navGgaTime = 0;             // Time of the last GGA
+static uint8_t navEpoch = NAV_EPOCH_REJECTED;
+
+gps_reject_counters_t gpsRejected;
+gps_geo_cycles_t gpsGeoCycles;
+int32_t previous_distance = -1; // Distance in cm at the last closer/farther decision, -1 before the first fix of a leg
+static guide_t gpsGuide;        // Turn cue from course versus waypoint bearing
+static uint32_t gpsNextPredict = 0; // RTC_getMillis() time of the next dead-reckoning step
+
+
+// Initialize GPS and peripherals
+void GPS_init(void) {
+    ring_init(&gpsRing, gpsStorage, GPS_RING_SIZE);
+    ring_init(&gpsEvents, gpsEventStorage, GPS_EVENT_QUEUE_SIZE);
+    gpsBurstActive = false;
+    memset(&gpsFix, 0, sizeof(gpsFix));
+    memset(&gpsRejected, 0, sizeof(gpsRejected));
+    navHeld.fields = 0;
+    navEpoch = NAV_EPOCH_REJECTED;
+    route_start(&navRoute, &routeDefault);
+    guide_reset(&gpsGuide);
+    track_init(&navTrack);
+    nmea_init(&gpsLexer, gpsHandlers, sizeof(gpsHandlers) / sizeof(gpsHandlers[0]));
+    TWI_init();    // Initialize I2C
+    USART2_INIT(); // Initialize UART for debugging
+}
+
+
+/**
+ * @brief Converts NMEA coordinates from degree minutes to decimal degrees format.
+ * 
+ * Works on the digits directly with integer math: the minutes are read as an
+ * integer in 1e-5 minute units and divided by 60 into 1e-7 degrees, so no
+ * precision is lost to a 32-bit float.
+ * 
+ * @param coord The NMEA coordinate string (e.g., "12345.678").
+ * @param direction The direction indicator ('N', 'S', 'E', or 'W').
+ * @return The coordinate in 1e-7 degrees.
+ */
+gps_coord_t convert_to_decimal(const char *coord, char direction) {
+    // dddmm.mmmmm as an integer in 1e-5 minutes
+    uint32_t raw = nmea_parse_fixed(coord, strlen(coord), 5);
+    uint32_t degrees = raw / 10000000UL;                 // Get the degrees part
+    uint32_t minutes = raw - degrees * 10000000UL;       // Minutes in 1e-5 units
+    
+    // 1e-5 minutes to 1e-7 degrees is a factor of 100 / 60, rounded
+    gps_coord_t decimal = degrees * GPS_COORD_SCALE + (minutes * 5 + 1) / 3;
+    if (direction == 'S' || direction == 'W') {
+        decimal = -decimal;  // If South or West, make the value negative
+    }
+    return decimal;
+}
+
+
+/**
+ * @brief Formats a coordinate as signed decimal degrees with 7 decimals.
+ * 
+ * @param coord Coordinate in 1e-7 degrees.
+ * @return The formatted coordinate.
+ */
+char* format_coord(gps_coord_t coord) {
+    static char formatted_coord[16];
+    uint32_t magnitude = (coord < 0) ? -(uint32_t)coord : (uint32_t)coord;
+    
+    snprintf(formatted_coord, sizeof(formatted_coord), "%s%lu.%07lu", (coord < 0) ? "-" : "",
+             (unsigned long)(magnitude / GPS_COORD_SCALE), (unsigned long)(magnitude % GPS_COORD_SCALE));
+    return formatted_coord;
+}
+
+/**
+ * @brief Converts an NMEA UTC time (hhmmss.sss as an integer in ms units) to 24-hour format (hh:mm:ss.sss).
+ * 
+ * @param time The time as hhmmss * 1000 + milliseconds.
+ * @return The time string in 24-hour format.
+ */
+char* convert_to_24hr_format(uint32_t time) {
+    static char formatted_time[20];  // Buffer for formatted time string
+
+    uint8_t hours = time / 10000000UL;
+    uint8_t minutes = (time / 100000UL) % 100;
+    uint8_t seconds = (time / 1000) % 100;
+    uint16_t millis = time % 1000;
+
+    // Check for valid hour, minute, and second values
+    if (hours >= 24 || minutes >= 60 || seconds >= 60) {
+        return "Invalid time values";  
+    }
+
+    // Format the time as a 24-hour string
+    snprintf(formatted_time, sizeof(formatted_time), "%02u:%02u:%02u.%03u", hours, minutes, seconds, millis);
+
+    return formatted_time;
+}
+
+
+// Function to convert degrees to radians
+double degrees_to_radians(double degrees) {
+    return degrees * M_PI / 180.0;
+}
+
+// Function to calculate the distance between two GPS coordinates
+double calc_distance(gps_coord_t lat1, gps_coord_t lon1, gps_coord_t lat2, gps_coord_t lon2) {
+    // Convert latitude from 1e-7 degrees to radians
+    double lat1_rad = degrees_to_radians(lat1 / (double)GPS_COORD_SCALE);
+    double lat2_rad = degrees_to_radians(lat2 / (double)GPS_COORD_SCALE);
+
+    // Differences are taken in integer form first so no precision is lost
+    double delta_lat = degrees_to_radians((lat2 - lat1) / (double)GPS_COORD_SCALE);
+    double delta_lon = degrees_to_radians((lon2 - lon1) / (double)GPS_COORD_SCALE);
+
+    // Haversine formula
+    double a = sin(delta_lat / 2) * sin(delta_lat / 2) +
+               cos(lat1_rad) * cos(lat2_rad) *
+               sin(delta_lon / 2) * sin(delta_lon / 2);
+    double c = 2 * atan2(sqrt(a), sqrt(1 - a));
+
+    // Distance in meters
+    return EARTH_RADIUS * c;
+}
+
+// Function to calculate the initial bearing from one GPS coordinate to another
+uint16_t calc_bearing(gps_coord_t lat1, gps_coord_t lon1, gps_coord_t lat2, gps_coord_t lon2) {
+    double lat1_rad = degrees_to_radians(lat1 / (double)GPS_COORD_SCALE);
+    double lat2_rad = degrees_to_radians(lat2 / (double)GPS_COORD_SCALE);
+    double delta_lon = degrees_to_radians((lon2 - lon1) / (double)GPS_COORD_SCALE);
+
+    double y = sin(delta_lon) * cos(lat2_rad);
+    double x = cos(lat1_rad) * sin(lat2_rad) - sin(lat1_rad) * cos(lat2_rad) * cos(delta_lon);
+    double bearing = atan2(y, x) * 18000.0 / M_PI;
+
+    // Bearing in 0.01 degrees, 0 - 35999
+    if (bearing < 0) bearing += 36000.0;
+    return (uint16_t)bearing % 36000;
+}
+
+// Time one call of each geometry function with TCB1
+void gps_profile_geo(void) {
+    // Inputs read through volatile so the calls are not folded at compile time
+    static volatile gps_coord_t lat1 = 430747000L;
+    static volatile gps_coord_t lon1 = -893842000L;
+    static volatile gps_coord_t lat2 = 430772438L;
+    static volatile gps_coord_t lon2 = -893806791L;
+    geo_origin_t origin;
+    geo_point_t from;
+    geo_point_t to;
+    uint16_t start;
+
+    geo_set_origin(&origin, lat1, lon1);
+    start = TCB1.CNT;
+    geo_project(&origin, lat1, lon1, &from);
+    gpsGeoCycles.project = TCB1.CNT - start;
+    geo_project(&origin, lat2, lon2, &to);
+
+    start = TCB1.CNT;
+    geo_distance(&from, &to);
+    gpsGeoCycles.distance = TCB1.CNT - start;
+
+    start = TCB1.CNT;
+    geo_bearing(&from, &to);
+    gpsGeoCycles.bearing = TCB1.CNT - start;
+
+    start = TCB1.CNT;
+    calc_distance(lat1, lon1, lat2, lon2);
+    gpsGeoCycles.haversine = TCB1.CNT - start;
+
+    start = TCB1.CNT;
+    calc_bearing(lat1, lon1, lat2, lon2);
+    gpsGeoCycles.greatCircle = TCB1.CNT - start;
+}
+
+/**
+ * @brief Picks the heading to steer by.
+ * The receiver's course over ground is preferred; without it the filtered
+ * velocity is used once the walker is clearly moving.
+ * 
+ * @param[out] course Heading in 0.01 degrees.
+ * @return true if a usable heading was found.
+ */
+static bool nav_course(uint16_t *course) {
+    if ((gpsFix.valid & GPS_VALID_MOTION) == GPS_VALID_MOTION && gpsFix.speed >= GPS_MIN_COURSE_SPEED) {
+        *course = gpsFix.course;
+        return true;
+    }
+    if (navTrack.initialized && track_speed(&navTrack) >= GPS_MIN_COURSE_SPEED) {
+        *course = track_course(&navTrack);
+        return true;
+    }
+    return false;
+}
+
+
+/**
+ * @brief Turns the current leg into haptic states.
+ * 
+ * While moving, the heading error to the waypoint picks left, straight or
+ * right. Otherwise the distance is compared with the last decision. Runs on
+ * every fix and on every dead-reckoning step in between.
+ * 
+ * @param report Print the status, only done for real fixes.
+ */
+static void nav_steer(bool report) {
+    uint32_t distance = navRoute.distance;
+    uint16_t course;
+    
+    if (!(statesActive & PULSE_ARRIVED)) {
+        statesActive &= ~(PULSE_LEFT | PULSE_MIDDLE | PULSE_RIGHT);
+        if (nav_course(&course)) {
+            uint8_t cue = guide_update(&gpsGuide, navRoute.bearing, course);
+            
+            statesActive &= ~(PULSE_DEST_CLOSER | PULSE_DEST_FARTHER);
+            if (cue == GUIDE_LEFT) {
+                statesActive |= PULSE_LEFT;
+                if (report) USART2_PRINTF("Turn left.\r\n");
+            } else if (cue == GUIDE_RIGHT) {
+                statesActive |= PULSE_RIGHT;
+                if (report) USART2_PRINTF("Turn right.\r\n");
+            } else {
+                statesActive |= PULSE_MIDDLE;
+                if (report) USART2_PRINTF("Straight ahead.\r\n");
+            }
+        } else {
+            guide_reset(&gpsGuide);
+            if (previous_distance >= 0 && distance + GPS_DISTANCE_DEADBAND < (uint32_t)previous_distance) {
+                statesActive |= PULSE_DEST_CLOSER;
+                statesActive &= ~PULSE_DEST_FARTHER;
+                if (report) USART2_PRINTF("You're getting closer to your destination.\r\n");
+                previous_distance = (int32_t)distance;
+            } else if (previous_distance >= 0 && distance > (uint32_t)previous_distance + GPS_DISTANCE_DEADBAND) {
+                statesActive |= PULSE_DEST_FARTHER;
+                statesActive &= ~PULSE_DEST_CLOSER;
+                if (report) USART2_PRINTF("You're moving away from the destination.\r\n");
+                previous_distance = (int32_t)distance;
+            }
+        }
+    }
+
+    // Print arrival status
+    if (report) {
+        USART2_PRINTF("-----------------------------------------------\r\n");
+        USART2_PRINTF("--------------------STATUS---------------------\r\n");
+        USART2_PRINTF("-----------------------------------------------\r\n");
+    }
+
+    // Arrived while the route is finished and the user is still inside the last waypoint's radius
+    if (navRoute.state == ROUTE_FINISHED && distance <= navRoute.radius * 100UL) {
+        // Arrival preempts navigation; a turn cue left set here would resume
+        // as soon as the arrival pattern ends
+        statesActive |= PULSE_ARRIVED;
+        statesActive &= ~(PULSE_LEFT | PULSE_MIDDLE | PULSE_RIGHT);
+        statesActive &= ~PULSE_DEST_FARTHER;
+        statesActive &= ~PULSE_DEST_CLOSER;
+        guide_reset(&gpsGuide);
+        if (report) USART2_PRINTF("You have arrived at your destination!\r\n");
+    } else {
+        if (report) USART2_PRINTF("Not yet at the destination. Keep going.\r\n");
+        statesActive &= ~PULSE_ARRIVED;
+    }
+
+    // Start the comparison from the first fix of a leg; after that it only
+    // moves when the distance has changed by more than the deadband
+    if (previous_distance < 0) {
+        previous_distance = (distance > INT32_MAX) ? INT32_MAX : (int32_t)distance;
+    }
+}
+
+
+/**
+ * @brief Checks progress along the route and prints status updates.
+ * 
+ * This function measures the current leg of navRoute from the new fix, which
+ * advances to the next waypoint once the user is inside the waypoint's radius.
+ * It prints the current status, whether the user is approaching, arrived, or still away from the waypoint.
+ * 
+ * @param curr_lat Current latitude in 1e-7 degrees.
+ * @param curr_lon Current longitude in 1e-7 degrees.
+ */
+void check_arrival(gps_coord_t curr_lat, gps_coord_t curr_lon) {
+    geo_point_t position;
+    uint8_t event;
+    uint32_t distance;
+    
+    // Smooth the fix in the route's frame so GPS jitter does not flip
+    // closer/farther from one fix to the next
+    if (geo_project(&navRoute.origin, curr_lat, curr_lon, &position)) {
+        track_update(&navTrack, &position, (gpsFix.valid & GPS_VALID_HDOP) ? gpsFix.hdop : 0, gpsFix.timestamp);
+        track_position(&navTrack, &position);
+        event = route_update_local(&navRoute, curr_lat, curr_lon, &position);
+    } else {
+        track_init(&navTrack);
+        event = route_update(&navRoute, curr_lat, curr_lon);
+    }
+    distance = navRoute.distance;
+    gpsNextPredict = RTC_getMillis() + GPS_PREDICT_MS;
+    
+    if (event & ROUTE_EVENT_WAYPOINT) {
+        previous_distance = -1; // New leg, nothing to compare with yet
+    }
+
+    // Print the active waypoint
+    USART2_PRINTF("----------------------------------------------\r\n");
+    USART2_PRINTF("-------------Destination Location-------------\r\n");
+    USART2_PRINTF("----------------------------------------------\r\n");
+    USART2_PRINTF_MOD("Waypoint %u of %u: ", navRoute.index + 1, route_waypoints(&navRoute));
+    USART2_PRINTF_MOD("%s, ", format_coord(navRoute.lat));
+    USART2_PRINTF_MOD("%s\r\n", format_coord(navRoute.lon));
+    USART2_PRINTF("-----------------------------------------------\r\n");
+    USART2_PRINTF("-----------Distance From Destination-----------\r\n");
+    USART2_PRINTF("-----------------------------------------------\r\n");
+    USART2_PRINTF_MOD("%lu.%02lu m, bearing %u.%02u\r\n", (unsigned long)(distance / 100), (unsigned long)(distance % 100),
+                      navRoute.bearing / 100, navRoute.bearing % 100);
+    if (event & ROUTE_EVENT_WAYPOINT) {
+        USART2_PRINTF("Waypoint reached, heading for the next one.\r\n");
+    }
+    if (navRoute.offRoute) {
+        int32_t offset = (navRoute.crossTrack < 0) ? -navRoute.crossTrack : navRoute.crossTrack;
+        USART2_PRINTF_MOD("Off route: %lu m %s of the path, steering back.\r\n", (unsigned long)(offset / 100),
+                          (navRoute.crossTrack < 0) ? "left" : "right");
+    } else if (event & ROUTE_EVENT_ON_ROUTE) {
+        USART2_PRINTF("Back on route.\r\n");
+    }
+    
+    nav_steer(true);
+
+    USART2_PRINTF("\r\n");
+    USART2_PRINTF("===================================================\r\n");
+}
+
+
+// Dead-reckon between fixes and rerun the route and turn logic
+void gps_predict(void) {
+    geo_point_t position;
+    uint32_t now = RTC_getMillis();
+    uint8_t event;
+    
+    if (!RTC_timeReached(now, gpsNextPredict)) {
+        return;
+    }
+    gpsNextPredict = now + GPS_PREDICT_MS;
+    
+    // Only while the filter is tracking and the last fix is recent
+    if (!navTrack.initialized || navRoute.state != ROUTE_ACTIVE || !track_predict(&navTrack, now, &position)) {
+        return;
+    }
+    
+    event = route_update_local(&navRoute, gpsFix.latitude, gpsFix.longitude, &position);
+    if (event & ROUTE_EVENT_WAYPOINT) {
+        previous_distance = -1;
+    }
+    nav_steer(false);
+}
+
+
+
+/**
+ * @brief Starts a new sentence by clearing the pending fix.
+ */
+static void nav_begin(void) {
+    navPending.fields = 0;
+}
+
+
+/**
+ * @brief Converts a GGA position field.
+ * 
+ * @param index Position field number, 0 = latitude, 1 = N/S, 2 = longitude, 3 = E/W.
+ * @param text Field text.
+ */
+static void nav_position_field(uint8_t index, const char *text) {
+    switch (index) {
+    case 0:
+        navPending.latitude = convert_to_decimal(text, 'N');
+        navPending.fields |= NAV_HAS_LAT;
+        break;
+    case 1:
+        if (text[0] == 'S') navPending.latitude = -navPending.latitude;
+        navPending.fields |= NAV_HAS_LAT_DIR;
+        break;
+    case 2:
+        navPending.longitude = convert_to_decimal(text, 'E');
+        navPending.fields |= NAV_HAS_LON;
+        break;
+    case 3:
+        if (text[0] == 'W') navPending.longitude = -navPending.longitude;
+        navPending.fields |= NAV_HAS_LON_DIR;
+        break;
+    default:
+        break;
+    }
+}
+
+
+/**
+ * @brief Copies the pending position and time into gpsFix.
+ */
+static void nav_commit_position(void) {
+    if (navPending.fields & NAV_HAS_TIME) {
+        gpsFix.time = navPending.time;
+        gpsFix.valid |= GPS_VALID_TIME;
+    }
+    gpsFix.latitude = navPending.latitude;
+    gpsFix.longitude = navPending.longitude;
+    gpsFix.timestamp = gpsReadyTime;
+    gpsFix.valid |= GPS_VALID_POSITION;
+}
+
+
+/**
+ * @brief Adds the pending speed and course to the held motion.
+ */
+static void nav_hold_motion(void) {
+    if (navPending.fields & NAV_HAS_SPEED) {
+        navHeld.speed = navPending.speed;
+        navHeld.fields |= NAV_HAS_SPEED;
+    }
+    if (navPending.fields & NAV_HAS_COURSE) {
+        navHeld.course = navPending.course;
+        navHeld.fields |= NAV_HAS_COURSE;
+    }
+}
+
+
+/**
+ * @brief Copies the held speed and course into gpsFix and empties the hold.
+ */
+static void nav_commit_motion(void) {
+    if (navHeld.fields & NAV_HAS_SPEED) {
+        gpsFix.speed = navHeld.speed;
+        gpsFix.valid |= GPS_VALID_SPEED;
+    }
+    if (navHeld.fields & NAV_HAS_COURSE) {
+        gpsFix.course = navHeld.course;
+        gpsFix.valid |= GPS_VALID_COURSE;
+    }
+    navHeld.fields = 0;
+}
+
+
+/**
+ * @brief Holds the pending motion, or settles it if its GGA was already gated.
+ */
+static void nav_update_motion(void) {
+    nav_hold_motion();
+    if (navEpoch == NAV_EPOCH_PASSED) {
+        nav_commit_motion();
+    } else if (navEpoch == NAV_EPOCH_REJECTED) {
+        navHeld.fields = 0;
+    }
+}
+
+
+/**
+ * @brief Converts one GGA field into the pending fix as it arrives.
+ * 
+ * Field 1 is the UTC time, fields 2-3 the latitude and hemisphere, fields
+ * 4-5 the longitude and hemisphere, field 6 the fix quality, field 7 the
+ * number of satellites used and field 8 the HDOP. Empty fields leave their
+ * bit in navPending.fields clear.
+ * 
+ * @param index Field number within the sentence.
+ * @param text Field text.
+ * @param length Field length.
+ */
+static void gga_field(uint8_t index, const char *text, uint8_t length) {
+    if (length == 0) {
+        return;
+    }
+    
+    switch (index) {
+    case 1:
+        navPending.time = nmea_parse_fixed(text, length, 3);
+        navPending.fields |= NAV_HAS_TIME;
+        break;
+    case 2: case 3: case 4: case 5:
+        nav_position_field(index - 2, text);
+        break;
+    case 6:
+        navPending.quality = nmea_parse_uint(text, length);
+        navPending.fields |= NAV_HAS_QUALITY;
+        break;
+    case 7:
+        navPending.satellites = nmea_parse_uint(text, length);
+        navPending.fields |= NAV_HAS_SATELLITES;
+        break;
+    case 8:
+        navPending.hdop = nmea_parse_fixed(text, length, 2);
+        navPending.fields |= NAV_HAS_HDOP;
+        break;
+    default:
+        break;
+    }
+}
+
+
+/**
+ * @brief Decides whether a GGA fix is good enough to navigate by.
+ * 
+ * @return 0 if the fix passes, otherwise the GPS_REJECT_* reason, which is
+ * also counted in gpsRejected.
+ */
+static uint8_t gga_gate(void) {
+    if (!(navPending.fields & NAV_HAS_QUALITY) || navPending.quality == GPS_QUALITY_INVALID ||
+        (navPending.fields & NAV_HAS_POSITION) != NAV_HAS_POSITION) {
+        gpsRejected.noFix++;
+        return GPS_REJECT_NO_FIX;
+    }
+    if (navPending.quality == GPS_QUALITY_ESTIMATED || navPending.quality > GPS_QUALITY_MAX) {
+        gpsRejected.lowQuality++;
+        return GPS_REJECT_QUALITY;
+    }
+    if (!(navPending.fields & NAV_HAS_SATELLITES) || navPending.satellites < GPS_MIN_SATELLITES) {
+        gpsRejected.fewSatellites++;
+        return GPS_REJECT_SATELLITES;
+    }
+    if (!(navPending.fields & NAV_HAS_HDOP) || navPending.hdop > GPS_MAX_HDOP) {
+        gpsRejected.highHdop++;
+        return GPS_REJECT_HDOP;
+    }
+    return 0;
+}
+
+
+/**
+ * @brief Handles a GGA sentence whose checksum matched.
+ * 
+ * The quality metadata is always recorded in gpsFix. Fixes that fail the
+ * gate are counted and kept away from the route and guidance logic; the
+ * last good fix stays in gpsFix with its position and motion no longer
+ * marked valid, and the motion held for the epoch is dropped. Otherwise the
+ * position and the held motion are committed, the position is compared
+ * with the destination and the parsed data is printed.
+ */
+static void gga_commit(void) {
+    gpsFix.quality = (navPending.fields & NAV_HAS_QUALITY) ? navPending.quality : GPS_QUALITY_INVALID;
+    gpsFix.satellites = (navPending.fields & NAV_HAS_SATELLITES) ? navPending.satellites : 0;
+    if (navPending.fields & NAV_HAS_HDOP) {
+        gpsFix.hdop = navPending.hdop;
+        gpsFix.valid |= GPS_VALID_HDOP;
+    } else {
+        gpsFix.valid &= ~GPS_VALID_HDOP;
+    }
+    
+    if (navPending.fields & NAV_HAS_TIME) {
+        navGgaTime = navPending.time;
+    }
+    if (gga_gate()) {
+        navEpoch = NAV_EPOCH_REJECTED;
+        navHeld.fields = 0;
+        gpsFix.valid &= ~(GPS_VALID_POSITION | GPS_VALID_MOTION);
+        return; // No fix, or not good enough to act on
+    }
+    navEpoch = NAV_EPOCH_PASSED;
+    if ((navHeld.fields & NAV_HAS_TIME) && (navPending.fields & NAV_HAS_TIME) && navHeld.time != navPending.time) {
+        navHeld.fields = 0; // Held from an epoch whose GGA never came
+    }
+    nav_commit_position();
+    nav_commit_motion();
+    
+    USART2_PRINTF_MOD("\n");
+    
+    // Check if the destination is reached based on current coordinates
+    check_arrival(navPending.latitude, navPending.longitude);
+
+    // Print the parsed data (time, latitude, longitude) for debugging
+    if (navPending.fields & NAV_HAS_TIME) {
+        USART2_PRINTF_MOD("Time: %s\r\n", convert_to_24hr_format(navPending.time));
+    }
+    USART2_PRINTF_MOD("Latitude: %s\r\n", format_coord(navPending.latitude));
+    USART2_PRINTF_MOD("Longitude: %s\r\n", format_coord(navPending.longitude));
+    USART2_PRINTF_MOD("Quality: %u, Satellites: %u, HDOP: %u.%02u\r\n", gpsFix.quality, gpsFix.satellites,
+                      gpsFix.hdop / 100, gpsFix.hdop % 100);
+    USART2_PRINTF_MOD("Fix read at %lu ms, handled after %lu ms\r\n", gpsFix.timestamp, RTC_elapsed(gpsFix.timestamp));
+    if ((gpsFix.valid & GPS_VALID_MOTION) == GPS_VALID_MOTION) {
+        USART2_PRINTF_MOD("Speed: %u cm/s, Course: %u.%02u\r\n", gpsFix.speed,
+                          gpsFix.course / 100, gpsFix.course % 100);
+    }
+}
+
+
+/**
+ * @brief Converts one RMC field into the pending fix as it arrives.
+ * 
+ * Field 1 is the UTC time, field 2 the status (A = valid, V = warning),
+ * field 7 the speed in knots and field 8 the course over ground in degrees
+ * true. The position in fields 3-6 is skipped; only the gated GGA position
+ * is navigated by.
+ * 
+ * @param index Field number within the sentence.
+ * @param text Field text.
+ * @param length Field length.
+ */
+static void rmc_field(uint8_t index, const char *text, uint8_t length) {
+    if (length == 0) {
+        return;
+    }
+    
+    switch (index) {
+    case 1:
+        navPending.time = nmea_parse_fixed(text, length, 3);
+        navPending.fields |= NAV_HAS_TIME;
+        break;
+    case 2:
+        if (text[0] != 'A') navPending.fields |= NAV_NO_FIX;
+        break;
+    case 7:
+        // Knots * 100 to cm/s is a factor of 0.514444, 8429 / 16384 in Q14
+        navPending.speed = (nmea_parse_fixed(text, length, 2) * 8429UL) >> 14;
+        navPending.fields |= NAV_HAS_SPEED;
+        break;
+    case 8:
+        navPending.course = nmea_parse_fixed(text, length, 2);
+        navPending.fields |= NAV_HAS_COURSE;
+        break;
+    default:
+        break;
+    }
+}
+
+
+/**
+ * @brief Handles an RMC sentence whose checksum matched.
+ * A warning status invalidates the position and motion in gpsFix. An RMC
+ * newer than the last GGA starts an epoch whose motion is held until its
+ * GGA passes the gate; one matching the last GGA follows that GGA's result.
+ */
+static void rmc_commit(void) {
+    if (navPending.fields & NAV_NO_FIX) {
+        gpsFix.valid &= ~(GPS_VALID_POSITION | GPS_VALID_MOTION);
+        navHeld.fields = 0;
+        return;
+    }
+    
+    if ((navPending.fields & NAV_HAS_TIME) && navPending.time != navGgaTime) {
+        navEpoch = NAV_EPOCH_WAITING;
+        navHeld.time = navPending.time;
+        navHeld.fields = NAV_HAS_TIME;
+    }
+    nav_update_motion();
+}
+
+
+/**
+ * @brief Converts one VTG field into the pending fix as it arrives.
+ * 
+ * Field 1 is the course in degrees true, field 5 the speed in knots, field 7
+ * the speed in km/h and field 9 the mode (N = not valid).
+ * 
+ * @param index Field number within the sentence.
+ * @param text Field text.
+ * @param length Field length.
+ */
+static void vtg_field(uint8_t index, const char *text, uint8_t length) {
+    if (length == 0) {
+        return;
+    }
+    
+    switch (index) {
+    case 1:
+        navPending.course = nmea_parse_fixed(text, length, 2);
+        navPending.fields |= NAV_HAS_COURSE;
+        break;
+    case 5:
+        navPending.speed = (nmea_parse_fixed(text, length, 2) * 8429UL) >> 14;
+        navPending.fields |= NAV_HAS_SPEED;
+        break;
+    case 7:
+        // km/h * 100 to cm/s is a factor of 0.277778, 4551 / 16384 in Q14
+        navPending.speed = (nmea_parse_fixed(text, length, 2) * 4551UL) >> 14;
+        navPending.fields |= NAV_HAS_SPEED;
+        break;
+    case 9:
+        if (text[0] == 'N') navPending.fields |= NAV_NO_FIX;
+        break;
+    default:
+        break;
+    }
+}
+
+
+/**
+ * @brief Handles a VTG sentence whose checksum matched.
+ * VTG has no time, so it belongs to the epoch of the last RMC or GGA.
+ */
+static void vtg_commit(void) {
+    if (navPending.fields & NAV_NO_FIX) {
+        gpsFix.valid &= ~GPS_VALID_MOTION;
+        navHeld.fields = 0;
+        return;
+    }
+    nav_update_motion();
+}
+
+
+/**
+ * @brief Converts one GSA field into the pending fix as it arrives.
+ * 
+ * Field 2 is the fix type (1 = none, 2 = 2D, 3 = 3D), fields 3-14 the
+ * satellites used and fields 15-17 the PDOP, HDOP and VDOP.
+ * 
+ * @param index Field number within the sentence.
+ * @param text Field text.
+ * @param length Field length.
+ */
+static void gsa_field(uint8_t index, const char *text, uint8_t length) {
+    if (length == 0) {
+        return;
+    }
+    
+    switch (index) {
+    case 2:
+        navPending.fixType = nmea_parse_uint(text, length);
+        navPending.fields |= NAV_HAS_FIX_TYPE;
+        break;
+    case 15:
+        navPending.pdop = nmea_parse_fixed(text, length, 2);
+        navPending.fields |= NAV_HAS_PDOP;
+        break;
+    case 16:
+        navPending.hdop = nmea_parse_fixed(text, length, 2);
+        navPending.fields |= NAV_HAS_HDOP;
+        break;
+    case 17:
+        navPending.vdop = nmea_parse_fixed(text, length, 2);
+        navPending.fields |= NAV_HAS_VDOP;
+        break;
+    default:
+        break;
+    }
+}
+
+
+/**
+ * @brief Handles a GSA sentence whose checksum matched.
+ * 
+ * Multi-constellation receivers send one GSA per system; the DOP values are
+ * the same in each, so the last one wins.
+ */
+static void gsa_commit(void) {
+    if (navPending.fields & NAV_HAS_FIX_TYPE) {
+        gpsFix.fixType = navPending.fixType;
+    }
+    
+    if (gpsFix.fixType >= GPS_FIX_2D && (navPending.fields & NAV_HAS_DOP) == NAV_HAS_DOP) {
+        gpsFix.pdop = navPending.pdop;
+        gpsFix.hdop = navPending.hdop;
+        gpsFix.vdop = navPending.vdop;
+        gpsFix.valid |= GPS_VALID_DOP | GPS_VALID_HDOP;
+    } else {
+        gpsFix.valid &= ~GPS_VALID_DOP;
+    }
+}
+
+
+/**
+ * @brief Converts one PMTK001 field as it arrives.
+ * Field 1 is the acknowledged command and field 2 the PMTK_ACK_* flag.
+ * 
+ * @param index Field number within the sentence.
+ * @param text Field text.
+ * @param length Field length.
+ */
+static void pmtk_ack_field(uint8_t index, const char *text, uint8_t length) {
+    if (index == 1) {
+        pmtkAck.pendingCommand = nmea_parse_uint(text, length);
+    } else if (index == 2) {
+        pmtkAck.pendingFlag = nmea_parse_uint(text, length);
+    }
+}
+
+
+/**
+ * @brief Publishes a PMTK001 acknowledgement whose checksum matched.
+ */
+static void pmtk_ack_commit(void) {
+    pmtkAck.command = pmtkAck.pendingCommand;
+    pmtkAck.flag = pmtkAck.pendingFlag;
+    pmtkAck.received = true;
+}
+
+
+/**
+ * @brief Writes a PMTK sentence to the receiver.
+ * 
+ * @param body Sentence body without "$" or checksum.
+ * @return 1 if the receiver accepted the bytes, 0 on a bus error.
+ */
+static uint8_t gps_send_command(const char *body) {
+    static uint8_t sentence[GPS_CMD_SIZE];
+    static twi_transaction_t write;
+    uint8_t checksum = 0;
+    int length;
+    
+    for (const char *c = body; *c != '\0'; c++) {
+        checksum ^= (uint8_t)*c;
+    }
+    length = snprintf((char *)sentence, sizeof(sentence), "$%s*%02X\r\n", body, checksum);
+    if (length < 0 || length >= (int)sizeof(sentence)) {
+        return 0; // Body too long
+    }
+    
+    write.address = GPS_ADDRESS;
+    write.direction = TWI_WRITE;
+    write.data = sentence;
+    write.length = (uint8_t)length;
+    write.callback = 0;
+    return TWI_submit(&write) && TWI_wait(&write);
+}
+
+
+/**
+ * @brief Reads the receiver output until a PMTK001 for a command arrives.
+ * 
+ * @param command Command number the acknowledgement must carry.
+ * @return The PMTK_ACK_* flag, or PMTK_ACK_TIMEOUT.
+ */
+static uint8_t gps_wait_ack(uint16_t command) {
+    static uint8_t chunk[GPS_CHUNK_SIZE];
+    static twi_transaction_t read;
+    uint32_t start = RTC_getMillis();
+    
+    while (RTC_elapsed(start) < GPS_CMD_TIMEOUT_MS) {
+        read.address = GPS_ADDRESS;
+        read.direction = TWI_READ;
+        read.data = chunk;
+        read.length = sizeof(chunk);
+        read.callback = 0;
+        if (!TWI_submit(&read) || !TWI_wait(&read)) {
+            continue;
+        }
+        
+        for (uint8_t i = 0; i < sizeof(chunk); i++) {
+            if (chunk[i] != 0x0A) {
+                nmea_feed(&gpsLexer, chunk[i]);
+            }
+            if (pmtkAck.received && pmtkAck.command == command) {
+                return pmtkAck.flag;
+            }
+        }
+    }
+    
+    return PMTK_ACK_TIMEOUT;
+}
+
+
+// Send a PMTK command and wait for its acknowledgement
+uint8_t gps_command(const char *body) {
+    uint16_t command;
+    uint8_t flag;
+    
+    if (strncmp(body, "PMTK", 4) != 0) {
+        return 0;
+    }
+    command = nmea_parse_uint(body + 4, 3);
+    
+    for (uint8_t attempt = 0; attempt < GPS_CMD_RETRIES; attempt++) {
+        pmtkAck.received = false;
+        if (!gps_send_command(body)) {
+            continue;
+        }
+        
+        flag = gps_wait_ack(command);
+        if (flag == PMTK_ACK_SUCCESS) {
+            return 1;
+        }
+        if (flag != PMTK_ACK_TIMEOUT) {
+            return 0; // Rejected, retrying will not help
+        }
+    }
+    
+    return 0;
+}
+
+
+// Trim the output to the consumed sentences and set the fix interval
+uint8_t gps_configure(void) {
+    char body[24];
+    uint8_t ok;
+    
+    // Per fix: GLL, RMC, VTG, GGA, GSA, GSV, then reserved and MTK-specific sentences
+    ok = gps_command("PMTK314,0,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0");
+    
+    snprintf(body, sizeof(body), "PMTK220,%u", (unsigned int)GPS_UPDATE_MS);
+    ok &= gps_command(body);
+    
+    return ok;
+}
+
+
+/**
+ * @brief Completion callback for a GPS chunk read, runs in the TWI interrupt.
+ * 
+ * The receiver pads its output with 0x0A once its buffer is empty. Each
+ * chunk is scanned as it completes and the burst ends at the first run of
+ * GPS_FILLER_RUN filler bytes; a lone 0x0A is just the end of a sentence.
+ * Chunks with data are appended to the intake ring, and the next chunk is
+ * queued straight away while the ring has room for it, so the whole burst
+ * runs in the background. The end of the burst is posted as a GPS_EVENT_*.
+ * 
+ * @param t The finished chunk read.
+ */
+static void gps_chunk_done(twi_transaction_t *t) {
+    uint8_t event = GPS_EVENT_BURST_DONE;
+    
+    if (t->status == TWI_STATUS_DONE) {
+        uint8_t run = gpsFillerRun;
+        uint8_t filler = 0;
+        uint8_t useful = 0;
+        
+        gpsChunks++;
+        for (uint8_t i = 0; i < GPS_CHUNK_SIZE; i++) {
+            if (t->data[i] != 0x0A) {
+                useful++;
+                run = 0;
+            } else if (++run >= GPS_FILLER_RUN) {
+                filler = 1;
+            }
+        }
+        gpsFillerRun = run;
+        gpsBurstUseful += useful;
+        
+        // Room was checked before the read, so the whole chunk fits
+        if (useful > 0) {
+            ring_write(&gpsRing, gpsChunk, GPS_CHUNK_SIZE);
+        }
+        
+        if (!filler) {
+            if (gpsChunks < GPS_BURST_CHUNKS && ring_space(&gpsRing) >= GPS_CHUNK_SIZE) {
+                if (TWI_submit(t)) {
+                    return;
+                }
+            } else {
+                event = GPS_EVENT_BURST_FULL; // Receiver still has data queued
+            }
+        }
+    }
+    
+    event_post(&gpsEvents, event);
+}
+
+
+/**
+ * @brief Picks the delay before the next burst from what the last one returned.
+ * 
+ * A burst that filled up without reaching filler means the receiver still
+ * has data queued, so the next read follows quickly. A burst with data that
+ * ended in filler has caught up with the receiver. A burst with no data at
+ * all doubles the interval, up to GPS_POLL_MAX_MS.
+ * 
+ * @param useful Non-filler bytes returned by the last burst.
+ * @param full Whether the burst was cut off by GPS_BURST_CHUNKS or a full ring.
+ */
+static void gps_adapt_interval(uint16_t useful, bool full) {
+    if (full) {
+        gpsPollInterval = GPS_POLL_MIN_MS;
+    } else if (useful > 0) {
+        gpsPollInterval = GPS_POLL_BASE_MS;
+    } else if (gpsPollInterval < GPS_POLL_MAX_MS / 2) {
+        gpsPollInterval *= 2;
+    } else {
+        gpsPollInterval = GPS_POLL_MAX_MS;
+    }
+}
+
+
+// Start GPS reads and hand completed bursts to the parser
+void gps_service(void) {
+    uint32_t now;
+    uint8_t event;
+    
+    // A stuck bus raises no interrupt, so the burst would never post its event
+    if (gpsBurstActive && RTC_deadlinePassed(gpsBurstDeadline)) {
+        gpsBurstTimeouts++;
+        TWI_abort(); // Ends the read through gps_chunk_done() if still queued
+        if (ring_count(&gpsEvents) == 0) {
+            event_post(&gpsEvents, GPS_EVENT_BURST_DONE);
+        }
+    }
+    
+    if (event_get(&gpsEvents, &event)) {
+        // The interrupt is done with the burst counters once it posts
+        gpsBurstActive = false;
+        gpsBytesRead += (uint16_t)gpsChunks * GPS_CHUNK_SIZE;
+        gpsUsefulBytes += gpsBurstUseful;
+        gps_adapt_interval(gpsBurstUseful, event == GPS_EVENT_BURST_FULL);
+        gpsNextPoll = RTC_getMillis() + gpsPollInterval;
+        
+        if (gpsBurstUseful > 0) {
+            gpsReadyTime = RTC_getMillis();
+            gps_data_ready = true;
+        }
+    }
+    
+    if (gpsBurstActive) {
+        return; // Burst still running in the background
+    }
+    
+    now = RTC_getMillis();
+    if (RTC_timeReached(now, gpsNextPoll)) {
+        if (ring_space(&gpsRing) < GPS_CHUNK_SIZE) {
+            gpsNextPoll = now + GPS_POLL_MIN_MS; // Parser is behind, the receiver keeps the data
+            return;
+        }
+        gpsChunks = 0;
+        gpsFillerRun = 0;
+        gpsBurstUseful = 0;
+        gpsRead.address = GPS_ADDRESS;
+        gpsRead.direction = TWI_READ;
+        gpsRead.data = gpsChunk;
+        gpsRead.length = GPS_CHUNK_SIZE;
+        gpsRead.callback = gps_chunk_done;
+        gpsBurstActive = true;
+        gpsBurstDeadline = now + GPS_BURST_TIMEOUT_MS;
+        if (!TWI_submit(&gpsRead)) {
+            gpsBurstActive = false;
+            gpsNextPoll = now + GPS_POLL_MIN_MS; // Bus queue full, try again shortly
+        }
+    }
+}
+
+
+// Check and parse GPS sentences
+void parse_gps_data(void) {
+    uint8_t chunk[GPS_CHUNK_SIZE];
+    uint8_t length;
+    
+    if (!gps_data_ready) return; // No new data
+    gps_data_ready = false; // Reset data-ready flag
+
+    // Process all available data, including chunks that land while parsing
+    while ((length = ring_read(&gpsRing, chunk, sizeof(chunk))) > 0) {
+        for (uint8_t i = 0; i < length; i++) {
+            // Skip the module's 0x0A filler, which can also appear mid-sentence
+            if (chunk[i] != 0x0A) {
+                nmea_feed(&gpsLexer, chunk[i]);
+            }
+        }
+    }
+}
+
+
@@ -1,125 +1,332 @@
-/* 
- * File:   gps_interrupt.h
- * Author: chehj
- *
- * Created on December 1, 2024, 11:35 AM
- */
-
-#ifndef GPS_H
-#define	GPS_H
-
-#include <avr/io.h>
-#include <stdbool.h>
-#include <stdio.h>
-
-#include <string.h>
-
-#include <stdlib.h>
-#include <string.h>
-#include <math.h> // For fabs()
-
-#include "i2c.h"
-
-
-// Constants
-#define GPS_ADDRESS 0x10 
-#define GPS_THRESHOLD 25
-#define MAX_PACKET_SIZE 255
-#define SCALE_FACTOR 1000000
-#define PULSE_LEFT    0x01
-#define PULSE_MIDDLE  0x02
-#define PULSE_RIGHT   0x04
-#define PULSE_CLOSER  0x08
-#define PULSE_FURTHER 0x10
-#define PULSE_ARRIVED 0x20
-#define PULSE_DEST_FARTHER 0x40
-#define PULSE_DEST_CLOSER 0x80
-#define EARTH_RADIUS 6371000 // Earth's radius in meters
-
-#define RED() PORTD.OUT |= PIN7_bm
-#define YELLOW() PORTD.OUT |= PIN5_bm
-#define GREEN() PORTA.OUT |= PIN7_bm
-
-// Global buffer and indices for GPS data handling
-extern volatile bool gps_data_ready;
-extern volatile uint8_t gpsData[MAX_PACKET_SIZE];  // Buffer to store GPS data
-extern volatile uint8_t _head;                      // Head pointer for writing data to gpsData
-extern volatile uint8_t _tail;                      // Tail pointer for reading data from gpsData
-extern char gps_buffer[MAX_PACKET_SIZE];            // Buffer to store the GPS sentence
-extern uint16_t buffer_index;                       // Current position in the buffer
-extern volatile uint8_t statesActive;
-
-
-
-/**
- * @brief Initializes GPS and required peripherals (I2C, UART, RTC).
- */
-void GPS_init(void);
-
-/**
- * @brief Converts NMEA coordinates to decimal degrees.
- * 
- * @param coord NMEA coordinate string (e.g., "12345.678").
- * @param direction Direction character ('N', 'S', 'E', or 'W').
- * @return Coordinate in decimal degrees.
- */
-double convert_to_decimal(const char *coord, char direction);
-
-/**
- * @brief Converts a time string from NMEA format (hhmmss.sss) to 24-hour format.
- * 
- * @param time_str NMEA time string.
- * @return Time string in 24-hour format.
- */
-char* convert_to_24hr_format(const char *time_str);
-
-/**
- * @brief Checks if the user has reached the destination.
- * 
- * @param curr_lat Current latitude in decimal degrees.
- * @param curr_lon Current longitude in decimal degrees.
- */
-void check_arrival(double curr_lat, double curr_lon);
-
-/**
- * @brief Parses a GPGGA sentence from the GPS data.
- * 
- * @param sentence GPGGA sentence string.
- */
-void parse_gngga(const char *sentence);
-
-/**
- * @brief Parses incoming GPS data and processes sentences.
- */
-void parse_gps_data(void);
-
-
-/**
- * @brief Converts an angle in degrees to radians.
- *
- * This function takes an angle in degrees and converts it to radians
- * using the formula: radians = degrees * ? / 180.
- *
- * @param degrees The angle in degrees.
- * @return The angle in radians.
- */
-double degrees_to_radians(double degrees);
-
-/**
- * @brief Calculates the great-circle distance between two GPS coordinates.
- *
- * This function computes the shortest distance between two points on the 
- * Earth's surface using the Haversine formula. Coordinates are provided 
- * as latitude and longitude in degrees.
- *
- * @param lat1 Latitude of the first point in degrees.
- * @param lon1 Longitude of the first point in degrees.
- * @param lat2 Latitude of the second point in degrees.
- * @param lon2 Longitude of the second point in degrees.
- * @return The distance in meters between the two points.
- */
-double calc_distance(double lat1, double lon1, double lat2, double lon2);
-
-
-#endif	/* GPS_H */
-
+/* 
+ * File:   gps_interrupt.h
+ * Author: chehj
+ *
+ * Created on December 1, 2024, 11:35 AM
+ */
+
+#ifndef GPS_H
+#define	GPS_H
+
+#include <avr/io.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <string.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h> // For fabs()
+
+#include "i2c.h"
+#include "nmea.h"
+#include "RTC_Operations.h" // For RTC_getMillis()
+
+
+// Constants
+#define GPS_ADDRESS 0x10 
+#define GPS_THRESHOLD 25
+#define MAX_PACKET_SIZE 255
+#define GPS_CHUNK_SIZE 32      // Bytes per I2C read
+#define GPS_BURST_CHUNKS 8     // Reads per poll
+#define GPS_BURST_SIZE (GPS_CHUNK_SIZE * GPS_BURST_CHUNKS)
+#define GPS_RING_SIZE 256      // Intake ring between the TWI interrupt and the parser
+#define GPS_EVENT_QUEUE_SIZE 4
+#define GPS_FILLER_RUN 4       // Consecutive 0x0A bytes that mark the receiver as drained
+#define SCALE_FACTOR 1000000
+#define PULSE_LEFT    0x01
+#define PULSE_MIDDLE  0x02
+#define PULSE_RIGHT   0x04
+#define PULSE_CLOSER  0x08
+#define PULSE_FURTHER 0x10
+#define PULSE_ARRIVED 0x20
+#define PULSE_DEST_FARTHER 0x40
+#define PULSE_DEST_CLOSER 0x80
+#define EARTH_RADIUS 6371000 // Earth's radius in meters
+#define GPS_COORD_SCALE 10000000L // gps_coord_t units per degree
+
+// Burst completion events posted by the TWI interrupt
+#define GPS_EVENT_BURST_DONE 1      // Reached filler, an error or an empty chunk
+#define GPS_EVENT_BURST_FULL 2      // Stopped with data left in the receiver
+
+// PMTK commands
+#define GPS_CMD_SIZE 64             // Largest command sentence, including "$", checksum and CR/LF
+#define PMTK_ACK_INVALID 0          // PMTK001 flags
+#define PMTK_ACK_UNSUPPORTED 1
+#define PMTK_ACK_FAILED 2
+#define PMTK_ACK_SUCCESS 3
+#define PMTK_ACK_TIMEOUT 0xFF       // No acknowledgement received
+
+// Time to wait for a PMTK001 acknowledgement (ms) and number of attempts
+#ifndef GPS_CMD_TIMEOUT_MS
+#define GPS_CMD_TIMEOUT_MS 500
+#endif
+#ifndef GPS_CMD_RETRIES
+#define GPS_CMD_RETRIES 3
+#endif
+
+// Adaptive poll interval bounds (ms)
+#ifndef GPS_POLL_MIN_MS
+#define GPS_POLL_MIN_MS 20      // Receiver still had data queued
+#endif
+#ifndef GPS_POLL_BASE_MS
+#define GPS_POLL_BASE_MS 200    // Receiver drained, next fix pending
+#endif
+#ifndef GPS_POLL_MAX_MS
+#define GPS_POLL_MAX_MS 800     // Longest backoff while the receiver is silent
+#endif
+
+// Longest a burst may run before the bus is reset (ms). A full burst takes
+// ~25 ms at 100 kHz.
+#ifndef GPS_BURST_TIMEOUT_MS
+#define GPS_BURST_TIMEOUT_MS 100
+#endif
+
+// Position fix interval requested with PMTK220 (ms)
+#ifndef GPS_UPDATE_MS
+#define GPS_UPDATE_MS 1000
+#endif
+
+// Latitude or longitude in 1e-7 degrees (~1.1 cm), negative for S and W
+typedef int32_t gps_coord_t;
+
+// Ground speed below which the course over ground is treated as noise (cm/s)
+#ifndef GPS_MIN_COURSE_SPEED
+#define GPS_MIN_COURSE_SPEED 50
+#endif
+
+// Dead-reckoning step between fixes (ms)
+#ifndef GPS_PREDICT_MS
+#define GPS_PREDICT_MS 200
+#endif
+
+// Change in distance needed before closer/farther flips (cm)
+#ifndef GPS_DISTANCE_DEADBAND
+#define GPS_DISTANCE_DEADBAND 300
+#endif
+
+// gps_fix_t.valid bits
+#define GPS_VALID_POSITION 0x01
+#define GPS_VALID_TIME 0x02
+#define GPS_VALID_SPEED 0x04
+#define GPS_VALID_COURSE 0x08
+#define GPS_VALID_DOP 0x10         // PDOP, HDOP and VDOP from GSA
+#define GPS_VALID_HDOP 0x20        // HDOP from GGA or GSA
+#define GPS_VALID_MOTION (GPS_VALID_SPEED | GPS_VALID_COURSE)
+
+// gps_fix_t.quality values, as reported by GGA
+#define GPS_QUALITY_INVALID 0
+#define GPS_QUALITY_GPS 1
+#define GPS_QUALITY_DGPS 2
+#define GPS_QUALITY_ESTIMATED 6    // Dead reckoning inside the receiver
+#define GPS_QUALITY_MAX 5          // Highest quality value accepted besides GPS_QUALITY_ESTIMATED
+
+// Fix gating thresholds
+#ifndef GPS_MIN_SATELLITES
+#define GPS_MIN_SATELLITES 4
+#endif
+#ifndef GPS_MAX_HDOP
+#define GPS_MAX_HDOP 500           // DOP * 100
+#endif
+
+// Reasons a GGA fix was rejected
+#define GPS_REJECT_NO_FIX 1
+#define GPS_REJECT_QUALITY 2
+#define GPS_REJECT_SATELLITES 3
+#define GPS_REJECT_HDOP 4
+
+// Rejected GGA fixes by reason
+typedef struct {
+    uint16_t noFix;         // Quality 0 or empty position fields
+    uint16_t lowQuality;    // Estimated or unknown fix quality
+    uint16_t fewSatellites; // Fewer than GPS_MIN_SATELLITES
+    uint16_t highHdop;      // HDOP above GPS_MAX_HDOP
+} gps_reject_counters_t;
+
+// gps_fix_t.fixType values, as reported by GSA
+#define GPS_FIX_NONE 1
+#define GPS_FIX_2D 2
+#define GPS_FIX_3D 3
+
+/**
+ * @brief Navigation fix merged from GGA, RMC, VTG and GSA.
+ * The position comes from GGA fixes that pass the quality gate; speed and
+ * course from RMC and VTG are held until the GGA of their epoch has passed.
+ * A GPS_VALID_* bit is cleared when the receiver reports the field as
+ * invalid or a GGA fix fails the gate.
+ */
+typedef struct {
+    uint32_t timestamp;     // RTC_getMillis() when the position was read from the receiver
+    uint32_t time;          // UTC hhmmss * 1000 + milliseconds
+    gps_coord_t latitude;   // 1e-7 degrees
+    gps_coord_t longitude;  // 1e-7 degrees
+    uint16_t speed;         // Ground speed in cm/s
+    uint16_t course;        // Course over ground in 0.01 degrees true
+    uint16_t pdop;          // Dilution of precision * 100
+    uint16_t hdop;
+    uint16_t vdop;
+    uint8_t fixType;        // GPS_FIX_* value
+    uint8_t quality;        // GPS_QUALITY_* value of the last GGA
+    uint8_t satellites;     // Satellites used in the last GGA
+    uint8_t valid;          // GPS_VALID_* bits
+} gps_fix_t;
+
+#define RED() PORTD.OUT |= PIN7_bm
+#define YELLOW() PORTD.OUT |= PIN5_bm
+#define GREEN() PORTA.OUT |= PIN7_bm
+
+// Global flags and buffers for GPS data handling
+extern volatile bool gps_data_ready;                // Burst data is waiting for parse_gps_data()
+extern uint16_t gpsPollInterval;                   // Current delay between bursts (ms)
+extern uint32_t gpsBytesRead;                       // Bytes read over I2C, filler included
+extern uint32_t gpsUsefulBytes;                     // Bytes read that were not 0x0A filler
+extern uint16_t gpsBurstTimeouts;                   // Bursts ended by GPS_BURST_TIMEOUT_MS
+extern nmea_lexer_t gpsLexer;                       // Lexer state and sentence/checksum counters
+extern gps_fix_t gpsFix;                            // Latest navigation fix
+extern gps_reject_counters_t gpsRejected;           // GGA fixes kept out of navigation
+extern volatile uint8_t statesActive;
+
+
+
+/**
+ * @brief Initializes GPS and required peripherals (I2C, UART, RTC).
+ */
+void GPS_init(void);
+
+/**
+ * @brief Sends a PMTK command and waits for its PMTK001 acknowledgement.
+ * Adds the "$", checksum and CR/LF around the body and retries if no
+ * acknowledgement arrives. Sentences read while waiting are parsed as usual.
+ * 
+ * @param body Sentence body without "$" or checksum (e.g., "PMTK220,1000").
+ * @return 1 if the receiver acknowledged success, 0 otherwise.
+ */
+uint8_t gps_command(const char *body);
+
+/**
+ * @brief Limits the receiver output to the sentences the parser consumes
+ * (RMC, VTG, GGA and GSA) and sets the fix interval to GPS_UPDATE_MS.
+ * Call with interrupts enabled, after RTC_init().
+ * 
+ * @return 1 if both commands were acknowledged, 0 otherwise.
+ */
+uint8_t gps_configure(void);
+
+/**
+ * @brief Converts NMEA coordinates to decimal degrees.
+ * 
+ * @param coord NMEA coordinate string (e.g., "12345.678").
+ * @param direction Direction character ('N', 'S', 'E', or 'W').
+ * @return Coordinate in 1e-7 degrees.
+ */
+gps_coord_t convert_to_decimal(const char *coord, char direction);
+
+/**
+ * @brief Formats a coordinate as signed decimal degrees.
+ * 
+ * @param coord Coordinate in 1e-7 degrees.
+ * @return Formatted coordinate string.
+ */
+char* format_coord(gps_coord_t coord);
+
+/**
+ * @brief Converts an NMEA UTC time to 24-hour format (hh:mm:ss.sss).
+ * 
+ * @param time The time as hhmmss * 1000 + milliseconds.
+ * @return Time string in 24-hour format.
+ */
+char* convert_to_24hr_format(uint32_t time);
+
+/**
+ * @brief Updates route progress and checks if the user has reached the destination.
+ * 
+ * @param curr_lat Current latitude in 1e-7 degrees.
+ * @param curr_lon Current longitude in 1e-7 degrees.
+ */
+void check_arrival(gps_coord_t curr_lat, gps_coord_t curr_lon);
+
+/**
+ * @brief Dead-reckons the position between fixes.
+ * Every GPS_PREDICT_MS, extrapolates the filtered position with the filtered
+ * velocity and reruns waypoint arrival and turn guidance on it, so cues do not
+ * wait for the next fix. Call from the main loop.
+ */
+void gps_predict(void);
+
+/**
+ * @brief Parses incoming GPS data and processes sentences.
+ * Drains the intake ring through the NMEA lexer; GGA, RMC, VTG and GSA
+ * sentences with a valid checksum update gpsFix.
+ */
+void parse_gps_data(void);
+
+/**
+ * @brief Runs GPS acquisition from the main loop.
+ * Starts a background I2C burst every gpsPollInterval ms and hands completed
+ * bursts to parse_gps_data(). Bursts stop early once the receiver only
+ * returns filler or the intake ring is full, and the interval adapts to how
+ * much data they return. A burst still running after GPS_BURST_TIMEOUT_MS
+ * aborts the bus so a stuck read cannot stop intake for good.
+ */
+void gps_service(void);
+
+
+/**
+ * @brief Converts an angle in degrees to radians.
+ *
+ * This function takes an angle in degrees and converts it to radians
+ * using the formula: radians = degrees * ? / 180.
+ *
+ * @param degrees The angle in degrees.
+ * @return The angle in radians.
+ */
+double degrees_to_radians(double degrees);
+
+/**
+ * @brief Calculates the great-circle distance between two GPS coordinates.
+ *
+ * This function computes the shortest distance between two points on the 
+ * Earth's surface using the Haversine formula. Coordinates are provided 
+ * as latitude and longitude in 1e-7 degrees.
+ *
+ * @param lat1 Latitude of the first point in 1e-7 degrees.
+ * @param lon1 Longitude of the first point in 1e-7 degrees.
+ * @param lat2 Latitude of the second point in 1e-7 degrees.
+ * @param lon2 Longitude of the second point in 1e-7 degrees.
+ * @return The distance in meters between the two points.
+ */
+double calc_distance(gps_coord_t lat1, gps_coord_t lon1, gps_coord_t lat2, gps_coord_t lon2);
+
+/**
+ * @brief Calculates the initial great-circle bearing between two GPS coordinates.
+ *
+ * @param lat1 Latitude of the start point in 1e-7 degrees.
+ * @param lon1 Longitude of the start point in 1e-7 degrees.
+ * @param lat2 Latitude of the end point in 1e-7 degrees.
+ * @param lon2 Longitude of the end point in 1e-7 degrees.
+ * @return Bearing in 0.01 degrees clockwise from north (0 - 35999).
+ */
+uint16_t calc_bearing(gps_coord_t lat1, gps_coord_t lon1, gps_coord_t lat2, gps_coord_t lon2);
+
+// CPU cycles of one call each, from gps_profile_geo() (TCB1, wraps above 65535)
+typedef struct {
+    uint16_t project;       // geo_project()
+    uint16_t distance;      // geo_distance()
+    uint16_t bearing;       // geo_bearing()
+    uint16_t haversine;     // calc_distance()
+    uint16_t greatCircle;   // calc_bearing()
+} gps_geo_cycles_t;
+
+extern gps_geo_cycles_t gpsGeoCycles;
+
+/**
+ * @brief Times the plane geometry against the haversine functions.
+ * Measures one call of each on a 400 m leg with TCB1 and stores the cycle
+ * counts in gpsGeoCycles. Call once after RTC_profileInit() with interrupts
+ * still disabled, so nothing else lands in the measurement.
+ */
+void gps_profile_geo(void);
+
+
+#endif	/* GPS_H */
+
@@ -0,0 +1,68 @@
+/*
+ * File:   guidance.c
+ * Author: chehj
+ *
+ * Created on December 10, 2024, 2:30 PM
+ */
+
+#include "guidance.h"
+
+
+// Clear the guidance state
+void guide_reset(guide_t *guide) {
+    guide->state = GUIDE_NONE;
+    guide->error = 0;
+}
+
+/**
+ * @brief Updates the turn cue from a new bearing and course.
+ *
+ * From straight, a turn starts once the error leaves GUIDE_TURN_BAND; a turn
+ * only ends once the error is back inside GUIDE_STRAIGHT_BAND. Near 180
+ * degrees the sign of the error is noise, so a turn in progress keeps its
+ * side until the error is clearly on the other side.
+ *
+ * @param guide Guidance state.
+ * @param bearing Bearing to the waypoint (0.01 degrees).
+ * @param course Course over ground (0.01 degrees).
+ * @return The new GUIDE_* state.
+ */
+uint8_t guide_update(guide_t *guide, uint16_t bearing, uint16_t course) {
+    int32_t diff = (int32_t)bearing - course;
+    int16_t error;
+    
+    // Shortest way round, -17999 to 18000
+    if (diff > 18000) diff -= 36000;
+    else if (diff <= -18000) diff += 36000;
+    error = (int16_t)diff;
+    guide->error = error;
+    
+    switch (guide->state) {
+    case GUIDE_LEFT:
+        if (error > -GUIDE_STRAIGHT_BAND && error < GUIDE_STRAIGHT_BAND) {
+            guide->state = GUIDE_STRAIGHT;
+        } else if (error >= GUIDE_TURN_BAND && error <= GUIDE_BEHIND_BAND) {
+            guide->state = GUIDE_RIGHT;
+        }
+        break;
+    case GUIDE_RIGHT:
+        if (error > -GUIDE_STRAIGHT_BAND && error < GUIDE_STRAIGHT_BAND) {
+            guide->state = GUIDE_STRAIGHT;
+        } else if (error <= -GUIDE_TURN_BAND && error >= -GUIDE_BEHIND_BAND) {
+            guide->state = GUIDE_LEFT;
+        }
+        break;
+    default:
+        // Straight, or no previous cue to hold on to
+        if (error >= GUIDE_TURN_BAND) {
+            guide->state = GUIDE_RIGHT;
+        } else if (error <= -GUIDE_TURN_BAND) {
+            guide->state = GUIDE_LEFT;
+        } else {
+            guide->state = GUIDE_STRAIGHT;
+        }
+        break;
+    }
+    
+    return guide->state;
+}
@@ -0,0 +1,60 @@
+/*
+ * File:   guidance.h
+ * Author: chehj
+ *
+ * Description:
+ * Turn guidance. Compares the bearing to the active waypoint with the
+ * course over ground and picks left, straight or right. Angular hysteresis
+ * bands keep the cue steady while the heading error wanders around a
+ * threshold.
+ *
+ * Created on December 10, 2024, 2:30 PM
+ */
+
+#ifndef GUIDANCE_H
+#define GUIDANCE_H
+
+#include <stdint.h>
+
+// Guidance states
+#define GUIDE_NONE 0            // No usable course, no cue
+#define GUIDE_STRAIGHT 1
+#define GUIDE_LEFT 2
+#define GUIDE_RIGHT 3
+
+// Hysteresis bands on the heading error (0.01 degrees)
+#ifndef GUIDE_STRAIGHT_BAND
+#define GUIDE_STRAIGHT_BAND 1500    // A turn ends once the error is back inside +-15 degrees
+#endif
+#ifndef GUIDE_TURN_BAND
+#define GUIDE_TURN_BAND 3000        // Straight turns into a turn beyond +-30 degrees
+#endif
+#ifndef GUIDE_BEHIND_BAND
+#define GUIDE_BEHIND_BAND 15000     // Beyond +-150 degrees a turn keeps its side
+#endif
+
+// Guidance state
+typedef struct {
+    uint8_t state;              // GUIDE_* value
+    int16_t error;              // Last heading error, positive = waypoint to the right (0.01 degrees)
+} guide_t;
+
+
+/**
+ * @brief Clears the guidance state, e.g. when the course becomes invalid.
+ *
+ * @param guide Guidance state.
+ */
+void guide_reset(guide_t *guide);
+
+/**
+ * @brief Updates the turn cue from a new bearing and course.
+ *
+ * @param guide Guidance state.
+ * @param bearing Bearing to the waypoint (0.01 degrees).
+ * @param course Course over ground (0.01 degrees).
+ * @return The new GUIDE_* state.
+ */
+uint8_t guide_update(guide_t *guide, uint16_t bearing, uint16_t course);
+
+#endif /* GUIDANCE_H */
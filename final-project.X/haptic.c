@@ -0,0 +1,289 @@
+/*
+ * File:   haptic.c
+ * Author: chehj
+ *
+ * Created on December 13, 2024, 9:30 AM
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <string.h>
+#include "haptic.h"
+#include "motor.h"
+#include "RTC_Operations.h" // For RTC_getMillis()
+
+// Pattern tables, kept in flash
+static const haptic_step_t leftSteps[] = {
+    { MIDDLE_MOTOR, HAPTIC_MS(200) },
+    { LEFT_MOTOR,   HAPTIC_MS(300) },
+    { 0,            HAPTIC_MS(200) },
+};
+static const haptic_step_t middleSteps[] = {
+    { MIDDLE_MOTOR, HAPTIC_MS(300) },
+    { 0,            HAPTIC_MS(200) },
+};
+static const haptic_step_t rightSteps[] = {
+    { MIDDLE_MOTOR, HAPTIC_MS(200) },
+    { RIGHT_MOTOR,  HAPTIC_MS(300) },
+    { 0,            HAPTIC_MS(200) },
+};
+static const haptic_step_t closerSteps[] = {
+    { LEFT_MOTOR | RIGHT_MOTOR, HAPTIC_MS(150) },
+    { 0,                        HAPTIC_MS(100) },
+};
+static const haptic_step_t furtherSteps[] = {
+    { MIDDLE_MOTOR, HAPTIC_MS(400) },
+    { 0,            HAPTIC_MS(600) },
+};
+static const haptic_step_t arrivedSteps[] = {
+    { ALL_MOTORS, HAPTIC_MS(500) },
+    { 0,          HAPTIC_MS(500) },
+};
+
+const haptic_pattern_t hapticLeft = HAPTIC_PATTERN(leftSteps, 3);
+const haptic_pattern_t hapticMiddle = HAPTIC_PATTERN(middleSteps, 3);
+const haptic_pattern_t hapticRight = HAPTIC_PATTERN(rightSteps, 3);
+const haptic_pattern_t hapticCloser = HAPTIC_PATTERN(closerSteps, HAPTIC_FOREVER);
+const haptic_pattern_t hapticFurther = HAPTIC_PATTERN(furtherSteps, HAPTIC_FOREVER);
+const haptic_pattern_t hapticArrived = HAPTIC_PATTERN(arrivedSteps, 4);
+
+volatile uint32_t hapticStepTime = 0;
+uint16_t hapticOnsetMax[HAPTIC_CLASSES];
+uint16_t hapticPreemptions = 0;
+
+// Sequencer state, owned by the TCB0 interrupt once a pattern is playing.
+// The main loop only touches it with interrupts masked.
+static haptic_player_t hapticPlayer;
+
+// Arbiter state
+static haptic_slot_t hapticSlots[HAPTIC_CLASSES];
+static uint8_t hapticPlaying = HAPTIC_CLASSES;          // Class on the motors, HAPTIC_CLASSES if none
+static const haptic_pattern_t *hapticPlayingPattern;    // Pattern it was started with
+static uint32_t hapticGapEnd = 0;                       // No new cue before this time (ms)
+
+
+/**
+ * @brief Sets up the motor pins and starts the TCB0 tick.
+ */
+void haptic_init(void) {
+    initMotors();
+    clearMotors();
+    hapticPlayer.pattern = 0;
+    memset(hapticSlots, 0, sizeof(hapticSlots));
+    memset(hapticOnsetMax, 0, sizeof(hapticOnsetMax));
+    for (uint8_t cls = 0; cls < HAPTIC_CLASSES; cls++) {
+        hapticSlots[cls].intensity = MOTOR_FULL;
+    }
+    hapticPlaying = HAPTIC_CLASSES;
+
+    TCB0.CCMP = HAPTIC_TCB_PERIOD;
+    TCB0.CTRLB = TCB_CNTMODE_INT_gc;
+    TCB0.INTCTRL = TCB_CAPT_bm;
+    TCB0.CTRLA = TCB_CLKSEL_CLKDIV2_gc | TCB_ENABLE_bm;
+}
+
+/**
+ * @brief Applies the current step to the motors.
+ * Runs with interrupts masked.
+ */
+static void haptic_apply(void) {
+    const haptic_step_t *step = &hapticPlayer.pattern->steps[hapticPlayer.step];
+
+    setMotors(step->motors);
+    hapticPlayer.ticks = step->ticks;
+    hapticStepTime = RTC_getMillis();
+}
+
+// Start a pattern from its first step
+void haptic_play(const haptic_pattern_t *pattern) {
+    uint8_t sreg = SREG;
+
+    cli();
+    hapticPlayer.pattern = pattern;
+    hapticPlayer.step = 0;
+    hapticPlayer.repeats = pattern->repeat;
+    TCB0.CNT = 0; // Give the first step whole ticks
+    haptic_apply();
+    SREG = sreg;
+}
+
+/**
+ * @brief Continues a pattern from a saved position.
+ * The interrupted step is restarted with the ticks it had left.
+ *
+ * @param progress Position saved by haptic_save().
+ */
+static void haptic_resume(const haptic_player_t *progress) {
+    uint8_t sreg = SREG;
+
+    cli();
+    hapticPlayer = *progress;
+    setMotors(progress->pattern->steps[progress->step].motors);
+    TCB0.CNT = 0;
+    hapticStepTime = RTC_getMillis();
+    SREG = sreg;
+}
+
+/**
+ * @brief Stops the sequencer and returns where it was.
+ *
+ * @param[out] progress Playback position, progress->pattern is 0 if idle.
+ */
+static void haptic_save(haptic_player_t *progress) {
+    uint8_t sreg = SREG;
+
+    cli();
+    *progress = hapticPlayer;
+    hapticPlayer.pattern = 0;
+    clearMotors();
+    SREG = sreg;
+}
+
+// Stop the current pattern
+void haptic_stop(void) {
+    uint8_t sreg = SREG;
+
+    cli();
+    hapticPlayer.pattern = 0;
+    clearMotors();
+    SREG = sreg;
+}
+
+// Pattern being played, 0 if none
+const haptic_pattern_t *haptic_current(void) {
+    const haptic_pattern_t *pattern;
+    uint8_t sreg = SREG;
+
+    cli(); // The pointer is two bytes, read it as one
+    pattern = hapticPlayer.pattern;
+    SREG = sreg;
+    return pattern;
+}
+
+// Request or withdraw the cue of a class
+void haptic_request(uint8_t cls, const haptic_pattern_t *pattern) {
+    haptic_slot_t *slot = &hapticSlots[cls];
+
+    if (pattern == slot->pattern) {
+        return; // Coalesce: already playing or waiting
+    }
+    slot->pattern = pattern;
+    slot->progress.pattern = 0;
+    slot->finished = 0;
+    slot->requested = RTC_getMillis();
+}
+
+// Check and clear the class's finished flag
+uint8_t haptic_finished(uint8_t cls) {
+    uint8_t finished = hapticSlots[cls].finished;
+
+    hapticSlots[cls].finished = 0;
+    return finished;
+}
+
+// Set the intensity of a class's cues
+void haptic_set_intensity(uint8_t cls, uint8_t intensity) {
+    hapticSlots[cls].intensity = intensity;
+    if (hapticPlaying == cls) {
+        setMotorIntensity(ALL_MOTORS, intensity);
+    }
+}
+
+// Map an obstacle distance to an intensity
+uint8_t haptic_proximity(uint16_t distance) {
+    if (distance <= HAPTIC_NEAR_CM) {
+        return MOTOR_FULL;
+    }
+    if (distance >= HAPTIC_FAR_CM) {
+        return HAPTIC_MIN_INTENSITY;
+    }
+    return HAPTIC_MIN_INTENSITY + (uint8_t)((uint32_t)(MOTOR_FULL - HAPTIC_MIN_INTENSITY)
+            * (HAPTIC_FAR_CM - distance) / (HAPTIC_FAR_CM - HAPTIC_NEAR_CM));
+}
+
+/**
+ * @brief Puts a class's cue on the motors, resuming it if it was preempted.
+ *
+ * @param cls Cue class with a pending pattern.
+ * @param now Current time in ms.
+ */
+static void haptic_start(uint8_t cls, uint32_t now) {
+    haptic_slot_t *slot = &hapticSlots[cls];
+
+    setMotorIntensity(ALL_MOTORS, slot->intensity);
+    if (slot->progress.pattern == slot->pattern) {
+        haptic_resume(&slot->progress);
+        slot->progress.pattern = 0;
+    } else {
+        uint32_t onset = now - slot->requested;
+
+        if (onset > hapticOnsetMax[cls]) {
+            hapticOnsetMax[cls] = (onset > 0xFFFF) ? 0xFFFF : (uint16_t)onset;
+        }
+        haptic_play(slot->pattern);
+    }
+    hapticPlaying = cls;
+    hapticPlayingPattern = slot->pattern;
+}
+
+// Pick the cue for the motors
+void haptic_update(void) {
+    uint32_t now = RTC_getMillis();
+    uint8_t best;
+
+    // Retire the cue on the motors once it is withdrawn, replaced or done
+    if (hapticPlaying < HAPTIC_CLASSES) {
+        haptic_slot_t *slot = &hapticSlots[hapticPlaying];
+
+        if (slot->pattern != hapticPlayingPattern) {
+            haptic_stop();
+        } else if (haptic_current() == 0) {
+            slot->pattern = 0;
+            slot->finished = 1;
+        }
+        if (slot->pattern != hapticPlayingPattern) {
+            hapticPlaying = HAPTIC_CLASSES;
+            hapticGapEnd = now + HAPTIC_GAP_MS;
+        }
+    }
+
+    for (best = 0; best < HAPTIC_CLASSES; best++) {
+        if (hapticSlots[best].pattern != 0) {
+            break;
+        }
+    }
+    if (best == HAPTIC_CLASSES || best >= hapticPlaying) {
+        return; // Nothing pending, or the cue playing outranks it
+    }
+
+    if (hapticPlaying < HAPTIC_CLASSES) {
+        // Preempt: park the lower class where it is and switch at once
+        haptic_save(&hapticSlots[hapticPlaying].progress);
+        hapticPreemptions++;
+    } else if (best != HAPTIC_OBSTACLE && !RTC_timeReached(now, hapticGapEnd)) {
+        return;
+    }
+    haptic_start(best, now);
+}
+
+/**
+ * @brief TCB0 interrupt, advances the sequencer every HAPTIC_TICK_MS.
+ */
+ISR(TCB0_INT_vect) {
+    TCB0.INTFLAGS = TCB_CAPT_bm;
+
+    if (hapticPlayer.pattern == 0 || --hapticPlayer.ticks > 0) {
+        return;
+    }
+
+    if (++hapticPlayer.step >= hapticPlayer.pattern->count) {
+        hapticPlayer.step = 0;
+        if (hapticPlayer.pattern->repeat != HAPTIC_FOREVER && --hapticPlayer.repeats == 0) {
+            hapticPlayer.pattern = 0;
+            clearMotors();
+            hapticStepTime = RTC_getMillis();
+            return;
+        }
+    }
+    haptic_apply();
+}
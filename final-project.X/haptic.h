@@ -0,0 +1,182 @@
+/*
+ * File:   haptic.h
+ * Author: chehj
+ *
+ * Description:
+ * Table-driven haptic pattern sequencer. A pattern is a short table of steps
+ * in flash, each giving the motors to run and for how many ticks, played a
+ * number of times. One sequencer runs the current pattern from a 10 ms TCB0
+ * interrupt and switches the motors once per step.
+ * On top of it, an arbiter picks between cues of three priority classes:
+ * obstacle over arrival over navigation. A higher class preempts a lower one
+ * at once and the lower one later resumes where it stopped; otherwise cues
+ * are separated by a minimum gap so they stay distinguishable. Each class
+ * also has a PWM intensity, which for obstacle cues follows the distance.
+ *
+ * Created on December 13, 2024, 9:30 AM
+ */
+
+#ifndef HAPTIC_H
+#define HAPTIC_H
+
+#include <stdint.h>
+
+#ifndef F_CPU
+#define F_CPU 3333333
+#endif
+
+// Sequencer tick (ms)
+#define HAPTIC_TICK_MS 10
+
+// TCB0 period for one tick, clocked at F_CPU / 2
+#define HAPTIC_TCB_PERIOD ((uint16_t)((F_CPU / 2) * HAPTIC_TICK_MS / 1000) - 1)
+
+// Convert a duration to ticks
+#define HAPTIC_MS(ms) ((ms) / HAPTIC_TICK_MS)
+
+// haptic_pattern_t.repeat value that plays the pattern until it is stopped
+#define HAPTIC_FOREVER 0
+
+// Cue classes, highest priority first
+#define HAPTIC_OBSTACLE 0
+#define HAPTIC_ARRIVAL 1
+#define HAPTIC_NAVIGATION 2
+#define HAPTIC_CLASSES 3
+
+// Quiet time between two cues that do not preempt each other (ms)
+#ifndef HAPTIC_GAP_MS
+#define HAPTIC_GAP_MS 150
+#endif
+
+// Proximity range mapped onto the obstacle cue intensity (cm)
+#ifndef HAPTIC_NEAR_CM
+#define HAPTIC_NEAR_CM 30       // Full intensity at or below this distance
+#endif
+#ifndef HAPTIC_FAR_CM
+#define HAPTIC_FAR_CM 300       // HAPTIC_MIN_INTENSITY at or beyond this distance
+#endif
+
+// Weakest intensity the motors still start reliably at
+#ifndef HAPTIC_MIN_INTENSITY
+#define HAPTIC_MIN_INTENSITY 70
+#endif
+
+// One step of a pattern
+typedef struct {
+    uint8_t motors;         // LEFT_MOTOR, MIDDLE_MOTOR and RIGHT_MOTOR bits to turn on
+    uint8_t ticks;          // Duration in HAPTIC_TICK_MS ticks, at least 1
+} haptic_step_t;
+
+// A pattern: the step table and how often to play it
+typedef struct {
+    const haptic_step_t *steps;
+    uint8_t count;          // Number of steps
+    uint8_t repeat;         // Number of times to play the steps, or HAPTIC_FOREVER
+} haptic_pattern_t;
+
+// Playback position in a pattern
+typedef struct {
+    const haptic_pattern_t *pattern; // 0 when idle
+    uint8_t step;           // Index of the step being played
+    uint8_t ticks;          // Ticks left in the step
+    uint8_t repeats;        // Plays left, unused for HAPTIC_FOREVER
+} haptic_player_t;
+
+// Arbiter state of one cue class
+typedef struct {
+    const haptic_pattern_t *pattern; // Requested pattern, 0 if none
+    haptic_player_t progress;        // Where it was preempted, progress.pattern is 0 otherwise
+    uint32_t requested;              // RTC_getMillis() of the request (ms)
+    uint8_t intensity;               // PWM level while the class is playing
+    uint8_t finished;                // A one-shot pattern played out since the last check
+} haptic_slot_t;
+
+// Define a pattern from a step table
+#define HAPTIC_PATTERN(steps, repeat) { (steps), sizeof(steps) / sizeof((steps)[0]), (repeat) }
+
+// Cue patterns
+extern const haptic_pattern_t hapticLeft;       // Turn left
+extern const haptic_pattern_t hapticMiddle;     // Keep straight on
+extern const haptic_pattern_t hapticRight;      // Turn right
+extern const haptic_pattern_t hapticCloser;     // Obstacle approaching
+extern const haptic_pattern_t hapticFurther;    // Obstacle moving away
+extern const haptic_pattern_t hapticArrived;    // Destination reached
+
+extern volatile uint32_t hapticStepTime;        // RTC_getMillis() of the last haptic step
+extern uint16_t hapticOnsetMax[HAPTIC_CLASSES]; // Longest request-to-start time per class (ms)
+extern uint16_t hapticPreemptions;              // Cues interrupted by a higher class
+
+
+/**
+ * @brief Sets up the motor pins and starts the TCB0 tick.
+ */
+void haptic_init(void);
+
+/**
+ * @brief Starts a pattern from its first step, replacing the current one.
+ * The first step is applied immediately.
+ *
+ * @param pattern Pattern to play.
+ */
+void haptic_play(const haptic_pattern_t *pattern);
+
+/**
+ * @brief Stops the current pattern and turns the motors off.
+ */
+void haptic_stop(void);
+
+/**
+ * @brief Returns the pattern being played.
+ *
+ * @return The pattern, or 0 once it has finished or been stopped.
+ */
+const haptic_pattern_t *haptic_current(void);
+
+/**
+ * @brief Requests a cue for a class, or withdraws it.
+ * Requesting the pattern the class already has is coalesced: it keeps
+ * playing, or keeps its place if preempted, instead of restarting.
+ *
+ * @param cls HAPTIC_OBSTACLE, HAPTIC_ARRIVAL or HAPTIC_NAVIGATION.
+ * @param pattern Pattern to play, 0 to withdraw the class's cue.
+ */
+void haptic_request(uint8_t cls, const haptic_pattern_t *pattern);
+
+/**
+ * @brief Reports whether the class's one-shot cue has played out.
+ * The flag is cleared by the call and by a new request.
+ *
+ * @param cls Cue class.
+ * @return 1 if the pattern finished since the last call.
+ */
+uint8_t haptic_finished(uint8_t cls);
+
+/**
+ * @brief Sets the motor intensity used for a class's cues.
+ * Applies at once if the class is playing.
+ *
+ * @param cls Cue class.
+ * @param intensity Duty cycle, 0 to MOTOR_FULL.
+ */
+void haptic_set_intensity(uint8_t cls, uint8_t intensity);
+
+/**
+ * @brief Maps an obstacle distance to a motor intensity.
+ * Linear from MOTOR_FULL at HAPTIC_NEAR_CM down to HAPTIC_MIN_INTENSITY at
+ * HAPTIC_FAR_CM.
+ *
+ * @param distance Distance in cm.
+ * @return Intensity for haptic_set_intensity().
+ */
+uint8_t haptic_proximity(uint16_t distance);
+
+/**
+ * @brief Runs the arbiter, call every sequencer tick or so.
+ * Retires finished or withdrawn cues, lets a higher class preempt the one
+ * playing and starts or resumes the highest pending cue once the gap has
+ * passed. Obstacle cues skip the gap, so they start on the first call after
+ * their request.
+ */
+void haptic_update(void);
+
+#endif /* HAPTIC_H */
@@ -1,154 +1,316 @@
-/*
- * File:   i2c.c
- * Author: chehj
- *
- * Created on November 13, 2024, 10:29 PM
- */
-
-#include "i2c.h"    // Include the header file for I2C functions and definitions
-#include "printf.h" // Include the header for printf functionality
-
-
-// Circular buffer to store received data from I2C
-uint8_t rxBuffer[32];          // Buffer to hold up to 32 bytes
-uint8_t rxBufferIndex = 0;      // Index to track the next byte to read from the buffer
-uint8_t rxBufferLength = 0;     // Length of data currently stored in the buffer
-
-
-/**
- * @brief Initialize the I2C (TWI) pins for SDA and SCL.
- * This sets the SDA and SCL pins as inputs and enables pull-up resistors.
- */
-void TWI_initPins() {
-    // Set pins for SDA and SCL as input (open-drain)
-    PORTA.DIRCLR = PIN2_bm | PIN3_bm;  // Set pins 2 and 3 as inputs
-
-    // Enable pull-up resistors for SDA and SCL
-    PORTA.PIN2CTRL = PORT_PULLUPEN_bm; // Pull-up for SDA
-    PORTA.PIN3CTRL = PORT_PULLUPEN_bm; // Pull-up for SCL
-}
-
-
-/**
- * @brief Initialize the TWI (I2C) interface.
- * This function configures the baud rate, hold time, debug mode, and bus state.
- */
-void TWI_init() {
-    
-    // Initialize the TWI pins
-    TWI_initPins();
-    
-    // Set the SDA hold time to 50ns
-    TWI0.CTRLA = TWI_SDAHOLD_50NS_gc;  
-    
-    // Enable the debug mode for TWI (I2C) interface
-    TWI0.DBGCTRL = TWI_DBGRUN_bm;  
-    
-    // Set the TWI bus to idle state
-    TWI0.MSTATUS = TWI_BUSSTATE_IDLE_gc;  
-    
-    // Set the baud rate for 100kHz using a 4MHz system clock (MBAUD = 10)
-    TWI0.MBAUD = 10;  
-    
-    // Enable the TWI interface
-    TWI0.MCTRLA = TWI_ENABLE_bm; 
-}
-
-
-/**
- * @brief Start a read operation on the TWI bus.
- * This function sends the slave address with the read bit set.
- * 
- * @param address The I2C slave address to read from.
- */
-void TWI_startRead(uint8_t address) {    
-    // Send the slave address with the read bit (1) set
-    TWI0.MADDR = (address << 1) | 1;
-   
-    // Wait for the read interrupt flag, indicating that data is ready
-    while (!(TWI0.MSTATUS & TWI_RIF_bm)); 
-}
-
-
-/**
- * @brief Read a specified number of bytes from the TWI bus.
- * 
- * @param data Pointer to a buffer where the received data will be stored.
- * @param len The number of bytes to read from the bus.
- * @return The number of bytes successfully read.
- */
-uint8_t readFromTWI(volatile uint8_t* data, uint8_t len) {
-    // Start the read operation for the given slave address
-    TWI_startRead(GPS_ADDRESS);
-
-    uint8_t bytesRead = 0;
-  
-    // Loop to read the specified number of bytes
-    for (uint8_t bCount = 0; bCount < len; bCount++) {
-
-        // Wait for the read flag (data is ready to be read)
-        while (!(TWI0.MSTATUS & TWI_RIF_bm));
-      
-        // Read the received byte from the data register
-        data[bCount] = TWI0.MDATA;
-        bytesRead++;
-        
-        // If more bytes need to be read, send ACK (acknowledgment)
-        if (bCount < (len - 1)) {
-            TWI0.MCTRLB = TWI_ACKACT_ACK_gc | TWI_MCMD_RECVTRANS_gc; // Send ACK for more data
-        } else {
-            // For the last byte, send NACK and end the read
-            TWI_endRead();
-        }
-    }
-     
-    return bytesRead; // Return the number of bytes read
-}
-
-
-/**
- * @brief Request a specific number of bytes from the GPS (or other device).
- * This function stores the received bytes in the global rxBuffer.
- * 
- * @param quantity The number of bytes to request from the device.
- * @return The number of bytes successfully read.
- */
-uint8_t requestByte(uint8_t quantity) {
-    // Read the specified number of bytes and store in rxBuffer
-    uint8_t read = readFromTWI(rxBuffer, quantity);
-    
-    // Reset the buffer index and update the buffer length
-    rxBufferIndex = 0;
-    rxBufferLength = read;
-
-    return read; // Return the number of bytes read
-}
-
-
-/**
- * @brief Read one byte at a time from the rxBuffer.
- * This function returns each successive byte stored in the buffer.
- * 
- * @return The next byte in the buffer, or -1 if there are no more bytes to read.
- */
-uint8_t read() {
-    int value = -1;
-  
-    // If there are bytes left in the buffer, return the next byte
-    if(rxBufferIndex < rxBufferLength) {
-        value = rxBuffer[rxBufferIndex];
-        ++rxBufferIndex; // Increment the buffer index for the next read
-    }
- 
-    return value; // Return the byte, or -1 if no more bytes
-}
-
-
-/**
- * @brief End the read operation and send a NACK with the stop condition.
- * This function signals the end of the read transaction on the TWI bus.
- */
-void TWI_endRead() {
-    // Send NACK and stop condition to end the transaction
-    TWI0.MCTRLB = TWI_ACKACT_NACK_gc | TWI_MCMD_STOP_gc;    
-}
+/*
+ * File:   i2c.c
+ * Author: chehj
+ *
+ * Description:
+ * Interrupt-driven TWI (I2C) master. Transactions are queued with
+ * TWI_submit() and run in the background by the TWI0 master interrupt;
+ * each one reports completion through its status field and an optional
+ * callback.
+ *
+ * Created on November 13, 2024, 10:29 PM
+ */
+
+#include "i2c.h"    // Include the header file for I2C functions and definitions
+#include "printf.h" // Include the header for printf functionality
+
+
+// Circular buffer to store received data from I2C
+volatile uint8_t rxBuffer[32];  // Buffer to hold up to 32 bytes
+uint8_t rxBufferIndex = 0;      // Index to track the next byte to read from the buffer
+uint8_t rxBufferLength = 0;     // Length of data currently stored in the buffer
+
+// Queue of pending transactions, the one at twiQueueTail is on the bus
+static twi_transaction_t *volatile twiQueue[TWI_QUEUE_SIZE];
+static volatile uint8_t twiQueueHead = 0;
+static volatile uint8_t twiQueueTail = 0;
+
+
+/**
+ * @brief Initialize the I2C (TWI) pins for SDA and SCL.
+ * This sets the SDA and SCL pins as inputs and enables pull-up resistors.
+ */
+void TWI_initPins() {
+    // Set pins for SDA and SCL as input (open-drain)
+    PORTA.DIRCLR = PIN2_bm | PIN3_bm;  // Set pins 2 and 3 as inputs
+
+    // Enable pull-up resistors for SDA and SCL
+    PORTA.PIN2CTRL = PORT_PULLUPEN_bm; // Pull-up for SDA
+    PORTA.PIN3CTRL = PORT_PULLUPEN_bm; // Pull-up for SCL
+}
+
+
+/**
+ * @brief Initialize the TWI (I2C) interface.
+ * This function configures the baud rate, hold time, debug mode, and bus state.
+ */
+void TWI_init() {
+    
+    // Initialize the TWI pins
+    TWI_initPins();
+    
+    // Empty the transaction queue
+    twiQueueHead = 0;
+    twiQueueTail = 0;
+    
+    // Set the SDA hold time to 50ns
+    TWI0.CTRLA = TWI_SDAHOLD_50NS_gc;  
+    
+    // Enable the debug mode for TWI (I2C) interface
+    TWI0.DBGCTRL = TWI_DBGRUN_bm;  
+    
+    // Set the TWI bus to idle state
+    TWI0.MSTATUS = TWI_BUSSTATE_IDLE_gc;  
+    
+    // Set the baud rate for 100kHz using a 4MHz system clock (MBAUD = 10)
+    TWI0.MBAUD = 10;  
+    
+    // Enable the TWI interface with read and write interrupts
+    TWI0.MCTRLA = TWI_ENABLE_bm | TWI_RIEN_bm | TWI_WIEN_bm; 
+}
+
+
+/**
+ * @brief Put the transaction at the head of the queue on the bus.
+ * Sending the address starts the transfer; the rest happens in TWI_service().
+ */
+static void TWI_startNext(void) {
+    twi_transaction_t *t;
+    
+    if (twiQueueTail == twiQueueHead) {
+        return; // Queue empty, bus stays idle
+    }
+    
+    t = twiQueue[twiQueueTail];
+    if (t->status != TWI_STATUS_PENDING) {
+        return; // Already started, e.g. queued from a completion callback
+    }
+    t->count = 0;
+    t->status = TWI_STATUS_BUSY;
+    TWI0.MADDR = (t->address << 1) | t->direction;
+}
+
+
+/**
+ * @brief Finish the transaction on the bus and start the next one.
+ * 
+ * @param status Final status, TWI_STATUS_DONE or TWI_STATUS_ERROR.
+ */
+static void TWI_finish(uint8_t status) {
+    twi_transaction_t *t = twiQueue[twiQueueTail];
+    
+    twiQueueTail = (twiQueueTail + 1) & TWI_QUEUE_MASK;
+    t->status = status;
+    if (t->callback) {
+        t->callback(t);
+    }
+    
+    TWI_startNext();
+}
+
+
+/**
+ * @brief Advance the transaction on the bus by one step.
+ * Runs from the TWI0 master interrupt, or from TWI_wait() when interrupts
+ * are masked.
+ */
+static void TWI_service(void) {
+    uint8_t status = TWI0.MSTATUS;
+    twi_transaction_t *t;
+    
+    if (twiQueueTail == twiQueueHead) {
+        TWI0.MSTATUS = TWI_RIF_bm | TWI_WIF_bm; // Spurious, clear the flags
+        return;
+    }
+    t = twiQueue[twiQueueTail];
+    
+    // Lost arbitration or bus error: give up on this transaction
+    if (status & (TWI_ARBLOST_bm | TWI_BUSERR_bm)) {
+        TWI0.MSTATUS = TWI_ARBLOST_bm | TWI_BUSERR_bm | TWI_RIF_bm | TWI_WIF_bm;
+        TWI0.MSTATUS = TWI_BUSSTATE_IDLE_gc;
+        TWI_finish(TWI_STATUS_ERROR);
+        return;
+    }
+    
+    if (status & TWI_RIF_bm) {
+        // Read: store the byte, then ACK for more or NACK and stop
+        t->data[t->count++] = TWI0.MDATA;
+        if (t->count < t->length) {
+            TWI0.MCTRLB = TWI_ACKACT_ACK_gc | TWI_MCMD_RECVTRANS_gc;
+        } else {
+            TWI0.MCTRLB = TWI_ACKACT_NACK_gc | TWI_MCMD_STOP_gc;
+            TWI_finish(TWI_STATUS_DONE);
+        }
+    } else if (status & TWI_WIF_bm) {
+        if (status & TWI_RXACK_bm) {
+            // Address or data byte was not acknowledged
+            TWI0.MCTRLB = TWI_MCMD_STOP_gc;
+            TWI_finish(TWI_STATUS_ERROR);
+        } else if (t->direction == TWI_WRITE && t->count < t->length) {
+            TWI0.MDATA = t->data[t->count++];
+        } else {
+            TWI0.MCTRLB = TWI_MCMD_STOP_gc;
+            TWI_finish(TWI_STATUS_DONE);
+        }
+    }
+}
+
+
+/**
+ * @brief TWI0 master interrupt, drives the queued transactions.
+ */
+ISR(TWI0_TWIM_vect) {
+    TWI_service();
+}
+
+
+/**
+ * @brief Queue a transaction to run in the background.
+ * The transaction must stay valid until its status is no longer
+ * TWI_STATUS_PENDING or TWI_STATUS_BUSY.
+ * 
+ * @param t Transaction with address, direction, data, length and callback set.
+ * @return 1 if the transaction was queued, 0 if the queue is full.
+ */
+uint8_t TWI_submit(twi_transaction_t *t) {
+    uint8_t sreg = SREG;
+    uint8_t next;
+    uint8_t wasIdle;
+    
+    cli();
+    next = (twiQueueHead + 1) & TWI_QUEUE_MASK;
+    if (next == twiQueueTail) {
+        SREG = sreg;
+        return 0;   // Queue full
+    }
+    
+    t->status = TWI_STATUS_PENDING;
+    wasIdle = (twiQueueTail == twiQueueHead);
+    twiQueue[twiQueueHead] = t;
+    twiQueueHead = next;
+    if (wasIdle) {
+        TWI_startNext();
+    }
+    SREG = sreg;
+    
+    return 1;
+}
+
+
+/**
+ * @brief Wait for a queued transaction to complete.
+ * If interrupts are masked the transfer is advanced by polling, so this is
+ * also safe to call from an interrupt. A transaction that does not finish
+ * within TWI_TIMEOUT_LOOPS polls is aborted.
+ * 
+ * @param t Transaction previously passed to TWI_submit().
+ * @return 1 if the transaction completed, 0 on error or timeout.
+ */
+uint8_t TWI_wait(twi_transaction_t *t) {
+    uint16_t loops = TWI_TIMEOUT_LOOPS;
+    
+    while (t->status == TWI_STATUS_PENDING || t->status == TWI_STATUS_BUSY) {
+        if (!(SREG & CPU_I_bm) && (TWI0.MSTATUS & (TWI_RIF_bm | TWI_WIF_bm))) {
+            TWI_service();
+        }
+        if (--loops == 0) {
+            TWI_abort();
+            break;
+        }
+    }
+    
+    return t->status == TWI_STATUS_DONE;
+}
+
+
+/**
+ * @brief Abort the transaction on the bus and drop every queued transaction.
+ * Used to recover from a device holding the bus. Each dropped transaction
+ * ends with TWI_STATUS_ERROR and its callback is called, as on a bus error,
+ * so owners waiting for the callback are not left hanging. Transactions
+ * queued from those callbacks are kept and started afterwards.
+ */
+void TWI_abort(void) {
+    uint8_t sreg = SREG;
+    uint8_t end;
+    
+    cli();
+    TWI0.MCTRLB = TWI_MCMD_STOP_gc;
+    TWI0.MSTATUS = TWI_BUSSTATE_IDLE_gc;
+    end = twiQueueHead;
+    while (twiQueueTail != end) {
+        twi_transaction_t *t = twiQueue[twiQueueTail];
+        
+        twiQueueTail = (twiQueueTail + 1) & TWI_QUEUE_MASK;
+        t->status = TWI_STATUS_ERROR;
+        if (t->callback) {
+            t->callback(t);
+        }
+    }
+    TWI_startNext();
+    SREG = sreg;
+}
+
+
+/**
+ * @brief Read a specified number of bytes from the GPS.
+ * Queues the read and waits for it to complete.
+ * 
+ * @param data Pointer to a buffer where the received data will be stored.
+ * @param len The number of bytes to read from the bus.
+ * @return The number of bytes successfully read.
+ */
+uint8_t readFromTWI(volatile uint8_t* data, uint8_t len) {
+    twi_transaction_t t = {
+        .address = GPS_ADDRESS,
+        .direction = TWI_READ,
+        .data = data,
+        .length = len,
+        .callback = 0
+    };
+    
+    if (len == 0 || !TWI_submit(&t)) {
+        return 0;
+    }
+    TWI_wait(&t);
+     
+    return t.count; // Return the number of bytes read
+}
+
+
+/**
+ * @brief Request a specific number of bytes from the GPS (or other device).
+ * This function stores the received bytes in the global rxBuffer.
+ * 
+ * @param quantity The number of bytes to request from the device.
+ * @return The number of bytes successfully read.
+ */
+uint8_t requestByte(uint8_t quantity) {
+    // Read the specified number of bytes and store in rxBuffer
+    uint8_t read = readFromTWI(rxBuffer, quantity);
+    
+    // Reset the buffer index and update the buffer length
+    rxBufferIndex = 0;
+    rxBufferLength = read;
+
+    return read; // Return the number of bytes read
+}
+
+
+/**
+ * @brief Read one byte at a time from the rxBuffer.
+ * This function returns each successive byte stored in the buffer.
+ * 
+ * @return The next byte in the buffer, or -1 if there are no more bytes to read.
+ */
+uint8_t read() {
+    int value = -1;
+  
+    // If there are bytes left in the buffer, return the next byte
+    if(rxBufferIndex < rxBufferLength) {
+        value = rxBuffer[rxBufferIndex];
+        ++rxBufferIndex; // Increment the buffer index for the next read
+    }
+ 
+    return value; // Return the byte, or -1 if no more bytes
+}
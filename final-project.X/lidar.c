@@ -1,51 +1,277 @@
-/*
- * File:   lidar.c
- * Author: chehj
- *
- * Created on December 1, 2024, 8:50 PM
- */
-
-#include "lidar.h"
-
-
-// Read data from LIDAR sensor following its protocol
-// Returns 1 if valid data received, 0 otherwise
-uint8_t readLidarData(uint16_t *distance) {
-    
-    char data[9];
-    uint8_t check;
-    
-    // Wait for first header byte (0x59)
-    data[0] = usartReadChar();
-    if (data[0] != HEADER) {
-        return 0;
-    }
-    
-    // Wait for second header byte (0x59)
-    data[1] = usartReadChar();
-    if (data[1] != HEADER) {
-        return 0;
-    }
-    
-    // Read remaining 7 bytes
-    for (int i = 2; i < 9; i++) {
-        data[i] = usartReadChar();
-    }
-    
-    // Calculate checksum (sum of first 8 bytes)
-    check = 0;
-    for (int i = 0; i < 8; i++) {
-        check += data[i];
-    }
-    
-    // Verify checksum
-    if (data[8] != (check & 0xFF)) {
-        return 0;
-    }
-    
-    // Extract distance value (bytes 2-3, little endian)
-    *distance = data[2] + data[3] * 256;
-    return 1;
-}
-
-
+/*
+ * File:   lidar.c
+ * Author: chehj
+ *
+ * Created on December 1, 2024, 8:50 PM
+ */
+
+#include "lidar.h"
+
+// Parser fed from the USART receive ring buffer
+lidar_parser_t lidarParser;
+
+
+/**
+ * @brief Drops bytes from the front of the parser buffer until it starts on a
+ * possible header. A header is two 0x59 bytes, or a single 0x59 as the last
+ * buffered byte whose partner has not arrived yet. The dropped bytes are
+ * counted as framing errors.
+ *
+ * @param parser Parser to realign.
+ * @param start First buffer position that may hold the next header.
+ */
+static void lidar_resync(lidar_parser_t *parser, uint8_t start) {
+    uint8_t i;
+    
+    for (i = start; i < parser->count; i++) {
+        if (parser->buf[i] == HEADER &&
+            (i + 1 == parser->count || parser->buf[i + 1] == HEADER)) {
+            break;
+        }
+    }
+    
+    // Shift the candidate frame to the front of the buffer
+    parser->framingErrors += i;
+    parser->count -= i;
+    for (uint8_t j = 0; j < parser->count; j++) {
+        parser->buf[j] = parser->buf[i + j];
+    }
+}
+
+/**
+ * @brief Resets a LIDAR frame parser and clears its error counters.
+ *
+ * @param parser Parser to reset.
+ */
+void lidar_parser_init(lidar_parser_t *parser) {
+    parser->count = 0;
+    parser->frames = 0;
+    parser->framingErrors = 0;
+    parser->checksumErrors = 0;
+}
+
+/**
+ * @brief Feeds one byte into the LIDAR frame parser.
+ * On a bad header or checksum the bytes already buffered are searched for the
+ * next header, so the parser locks back on within one frame.
+ *
+ * @param parser Parser state.
+ * @param byte Next byte received from the sensor.
+ * @param[out] frame Decoded frame, written only when 1 is returned.
+ * @return 1 if the byte completed a valid frame, 0 otherwise.
+ */
+uint8_t lidar_parse_byte(lidar_parser_t *parser, uint8_t byte, lidar_frame_t *frame) {
+    uint8_t *buf = parser->buf;
+    uint8_t check;
+    
+    // The first two bytes of a frame must both be the header; a lone
+    // buffered header byte is dropped along with this one
+    if (parser->count < 2 && byte != HEADER) {
+        parser->framingErrors += parser->count + 1;
+        parser->count = 0;
+        return 0;
+    }
+    
+    buf[parser->count++] = byte;
+    if (parser->count < BUF_SIZE) {
+        return 0;
+    }
+    
+    // Calculate checksum (sum of first 8 bytes)
+    check = 0;
+    for (uint8_t i = 0; i < BUF_SIZE - 1; i++) {
+        check += buf[i];
+    }
+    
+    if (buf[BUF_SIZE - 1] != check) {
+        parser->checksumErrors++;
+        lidar_resync(parser, 1);
+        return 0;
+    }
+    
+    // Distance (bytes 2-3), strength (bytes 4-5), temperature (bytes 6-7), little endian
+    frame->distance = buf[2] | ((uint16_t)buf[3] << 8);
+    frame->strength = buf[4] | ((uint16_t)buf[5] << 8);
+    frame->temperature = (int16_t)((buf[6] | ((uint16_t)buf[7] << 8)) >> 3) - 256;
+    
+    parser->frames++;
+    parser->count = 0;
+    return 1;
+}
+
+// Read data from LIDAR sensor following its protocol
+// Blocks until a valid frame has been received
+uint8_t readLidarData(uint16_t *distance) {
+    lidar_frame_t frame;
+    
+    while (!lidar_parse_byte(&lidarParser, usartReadChar(), &frame));
+    
+    *distance = frame.distance;
+    return 1;
+}
+
+/**
+ * @brief Assembles LIDAR frames from the USART receive ring buffer without blocking.
+ * Stops as soon as a frame is complete; any remaining bytes stay in the ring
+ * buffer for the next call.
+ * Complete frames are timestamped with RTC_getMillis().
+ *
+ * @param[out] frame Pointer to store the decoded frame.
+ * @return 1 if a complete, valid frame was decoded, 0 otherwise.
+ */
+uint8_t lidar_poll(lidar_frame_t *frame) {
+    uint8_t c;
+    
+    while (usartTryReadChar(&c)) {
+        if (lidar_parse_byte(&lidarParser, c, frame)) {
+            frame->timestamp = RTC_getMillis();
+            return 1;
+        }
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief Sends a command frame to the sensor.
+ * Adds the header, length and checksum around the command ID and payload.
+ *
+ * @param id Command ID.
+ * @param data Command payload.
+ * @param len Number of payload bytes.
+ */
+static void lidar_send_command(uint8_t id, const uint8_t *data, uint8_t len) {
+    uint8_t check = CMD_HEADER + (len + 4) + id;
+    
+    usartWriteChar(CMD_HEADER);
+    usartWriteChar(len + 4);
+    usartWriteChar(id);
+    for (uint8_t i = 0; i < len; i++) {
+        usartWriteChar(data[i]);
+        check += data[i];
+    }
+    usartWriteChar(check);
+}
+
+/**
+ * @brief Waits for the response frame to a command.
+ * Data frames and anything else received in the meantime are discarded.
+ *
+ * @param id Command ID the response must carry.
+ * @param[out] response Buffer for the response frame, CMD_MAX_SIZE bytes.
+ * @return Length of the response frame, or 0 on timeout.
+ */
+static uint8_t lidar_read_response(uint8_t id, uint8_t *response) {
+    uint32_t start = RTC_getMillis();
+    uint8_t count = 0;
+    uint8_t check = 0;
+    uint8_t c;
+    
+    while ((RTC_getMillis() - start) < LIDAR_CMD_TIMEOUT_MS) {
+        if (!usartTryReadChar(&c)) {
+            continue;
+        }
+        
+        // Wait for the header, then a plausible length
+        if ((count == 0 && c != CMD_HEADER) ||
+            (count == 1 && (c < 4 || c > CMD_MAX_SIZE))) {
+            count = 0;
+            check = 0;
+            continue;
+        }
+        
+        response[count++] = c;
+        if (count < 2 || count < response[1]) {
+            check += c;
+            continue;
+        }
+        
+        // Complete frame: checksum is the low byte of the sum of all other bytes
+        if (c == check && response[2] == id) {
+            return count;
+        }
+        count = 0;
+        check = 0;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief Sends a command and waits for its response, retrying on timeout.
+ *
+ * @param id Command ID.
+ * @param data Command payload.
+ * @param len Number of payload bytes.
+ * @param[out] response Buffer for the response frame, CMD_MAX_SIZE bytes.
+ * @return Length of the response frame, or 0 if the sensor never answered.
+ */
+static uint8_t lidar_command(uint8_t id, const uint8_t *data, uint8_t len, uint8_t *response) {
+    uint8_t received;
+    
+    for (uint8_t attempt = 0; attempt < LIDAR_CMD_RETRIES; attempt++) {
+        lidar_send_command(id, data, len);
+        received = lidar_read_response(id, response);
+        if (received) {
+            return received;
+        }
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief Sets the sensor frame rate.
+ * A rate of 0 puts the sensor in trigger mode, where it only measures when
+ * lidar_trigger() is called. The sensor echoes the command as acknowledgement.
+ *
+ * @param rate Frame rate in Hz, or 0 for trigger mode.
+ * @return 1 if the sensor acknowledged the new rate, 0 otherwise.
+ */
+uint8_t lidar_set_frame_rate(uint16_t rate) {
+    uint8_t data[2] = { rate & 0xFF, rate >> 8 };
+    uint8_t response[CMD_MAX_SIZE];
+    
+    if (lidar_command(CMD_ID_FRAME_RATE, data, 2, response) != 6) {
+        return 0;
+    }
+    return response[3] == data[0] && response[4] == data[1];
+}
+
+/**
+ * @brief Sets the sensor output format.
+ * The sensor echoes the command as acknowledgement.
+ *
+ * @param format LIDAR_FORMAT_CM or LIDAR_FORMAT_MM.
+ * @return 1 if the sensor acknowledged the new format, 0 otherwise.
+ */
+uint8_t lidar_set_output_format(uint8_t format) {
+    uint8_t response[CMD_MAX_SIZE];
+    
+    if (lidar_command(CMD_ID_OUTPUT_FORMAT, &format, 1, response) != 5) {
+        return 0;
+    }
+    return response[3] == format;
+}
+
+/**
+ * @brief Saves the current settings to the sensor's flash.
+ *
+ * @return 1 if the sensor reported success, 0 otherwise.
+ */
+uint8_t lidar_save_settings(void) {
+    uint8_t response[CMD_MAX_SIZE];
+    
+    if (lidar_command(CMD_ID_SAVE, 0, 0, response) != 5) {
+        return 0;
+    }
+    return response[3] == 0;   // Status 0 means success
+}
+
+/**
+ * @brief Requests a single measurement while the sensor is in trigger mode.
+ * The measurement arrives as a normal data frame through lidar_poll().
+ */
+void lidar_trigger(void) {
+    lidar_send_command(CMD_ID_TRIGGER, 0, 0);
+}
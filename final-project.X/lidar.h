@@ -1,28 +1,131 @@
-/*
- * File:   lidar.h
- * Author: chehj
- *
- * Created on December 1, 2024, 8:50 PM
- */
-
-#ifndef LIDAR_H
-#define LIDAR_H
-
-#include <stdint.h>   // For uint8_t, uint16_t
-#include "usart.h"    // For usartReadChar()
-#include <avr/io.h>
-
-// Constants
-#define HEADER 0x59       // LIDAR header byte
-#define BUF_SIZE 9        // Buffer size for LIDAR packet
-
-
-/**
- * @brief Reads data from the LIDAR sensor following its protocol.
- *
- * @param[out] distance Pointer to store the distance value read from the sensor.
- * @return 1 if valid data is received, 0 otherwise.
- */
-uint8_t readLidarData(uint16_t *distance);
-
-#endif /* LIDAR_H */
+/*
+ * File:   lidar.h
+ * Author: chehj
+ *
+ * Created on December 1, 2024, 8:50 PM
+ */
+
+#ifndef LIDAR_H
+#define LIDAR_H
+
+#include <stdint.h>   // For uint8_t, uint16_t
+#include "usart.h"    // For usartReadChar()
+#include "RTC_Operations.h" // For RTC_getMillis()
+#include <avr/io.h>
+
+// Constants
+#define HEADER 0x59       // LIDAR header byte
+#define BUF_SIZE 9        // Buffer size for LIDAR packet
+
+// Command frames
+#define CMD_HEADER 0x5A           // Command and response header byte
+#define CMD_MAX_SIZE 8            // Largest response frame handled
+#define CMD_ID_TRIGGER 0x04       // Trigger a single measurement
+#define CMD_ID_FRAME_RATE 0x03    // Set frame rate, 0 selects trigger mode
+#define CMD_ID_OUTPUT_FORMAT 0x05 // Set output format
+#define CMD_ID_SAVE 0x11          // Save settings to the sensor's flash
+
+// Output formats for lidar_set_output_format()
+#define LIDAR_FORMAT_CM 0x01      // Standard 9-byte frame, distance in cm
+#define LIDAR_FORMAT_MM 0x06      // Standard 9-byte frame, distance in mm
+
+// Time to wait for a command response (ms) and number of attempts
+#ifndef LIDAR_CMD_TIMEOUT_MS
+#define LIDAR_CMD_TIMEOUT_MS 100
+#endif
+#ifndef LIDAR_CMD_RETRIES
+#define LIDAR_CMD_RETRIES 3
+#endif
+
+// Decoded TFMini data frame
+typedef struct {
+    uint16_t distance;      // Distance in cm
+    uint16_t strength;      // Signal strength
+    int16_t temperature;    // Chip temperature in degrees Celsius
+    uint32_t timestamp;     // Receive time in ms, set by lidar_poll()
+} lidar_frame_t;
+
+// Incremental frame parser state and error counters
+typedef struct {
+    uint8_t buf[BUF_SIZE];      // Bytes of the frame being assembled
+    uint8_t count;              // Number of bytes in buf
+    uint16_t frames;            // Valid frames decoded
+    uint16_t framingErrors;     // Bytes dropped while searching for a header, bad frames included
+    uint16_t checksumErrors;    // Complete frames with a bad checksum
+} lidar_parser_t;
+
+// Parser used by readLidarData() and lidar_poll()
+extern lidar_parser_t lidarParser;
+
+/**
+ * @brief Resets a LIDAR frame parser and clears its error counters.
+ *
+ * @param parser Parser to reset.
+ */
+void lidar_parser_init(lidar_parser_t *parser);
+
+/**
+ * @brief Feeds one byte into the LIDAR frame parser.
+ * Resynchronizes on the next header already buffered after a framing or
+ * checksum error.
+ *
+ * @param parser Parser state.
+ * @param byte Next byte received from the sensor.
+ * @param[out] frame Decoded frame, written only when 1 is returned.
+ * @return 1 if the byte completed a valid frame, 0 otherwise.
+ */
+uint8_t lidar_parse_byte(lidar_parser_t *parser, uint8_t byte, lidar_frame_t *frame);
+
+/**
+ * @brief Reads data from the LIDAR sensor following its protocol.
+ * Blocks until a valid frame has been received.
+ *
+ * @param[out] distance Pointer to store the distance value read from the sensor.
+ * @return 1 once valid data is received.
+ */
+uint8_t readLidarData(uint16_t *distance);
+
+/**
+ * @brief Polls the USART receive buffer for a complete LIDAR frame.
+ * Never blocks; bytes of an incomplete frame are kept until the next call.
+ * Complete frames are timestamped with RTC_getMillis().
+ *
+ * @param[out] frame Pointer to store the decoded frame.
+ * @return 1 if a complete, valid frame is ready, 0 otherwise.
+ */
+uint8_t lidar_poll(lidar_frame_t *frame);
+
+/**
+ * @brief Sets the sensor frame rate.
+ * A rate of 0 puts the sensor in trigger mode, where it only measures when
+ * lidar_trigger() is called.
+ *
+ * @param rate Frame rate in Hz, or 0 for trigger mode.
+ * @return 1 if the sensor acknowledged the new rate, 0 otherwise.
+ */
+uint8_t lidar_set_frame_rate(uint16_t rate);
+
+/**
+ * @brief Sets the sensor output format.
+ *
+ * @param format LIDAR_FORMAT_CM or LIDAR_FORMAT_MM.
+ * @return 1 if the sensor acknowledged the new format, 0 otherwise.
+ */
+uint8_t lidar_set_output_format(uint8_t format);
+
+/**
+ * @brief Saves the current settings to the sensor's flash.
+ * The flash has limited write endurance, so this should not be called on
+ * every power-up.
+ *
+ * @return 1 if the sensor reported success, 0 otherwise.
+ */
+uint8_t lidar_save_settings(void);
+
+/**
+ * @brief Requests a single measurement while the sensor is in trigger mode.
+ * The measurement arrives as a normal data frame through lidar_poll().
+ */
+void lidar_trigger(void);
+
+#endif /* LIDAR_H */
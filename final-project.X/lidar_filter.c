@@ -0,0 +1,91 @@
+/*
+ * File:   lidar_filter.c
+ * Author: chehj
+ *
+ * Created on December 6, 2024, 4:10 PM
+ */
+
+#include "lidar_filter.h"
+
+
+/**
+ * @brief Resets the filter state.
+ *
+ * @param filter Filter to reset.
+ */
+void lidar_filter_init(lidar_filter_t *filter) {
+    filter->index = 0;
+    filter->count = 0;
+    filter->ema = 0;
+    filter->rejected = 0;
+}
+
+/**
+ * @brief Returns the median of the samples currently in the window.
+ * Insertion sort of at most nine values, which is cheaper than keeping the
+ * window sorted for such small sizes.
+ *
+ * @param filter Filter state.
+ * @return Median distance in cm.
+ */
+static uint16_t lidar_filter_median(const lidar_filter_t *filter) {
+    uint16_t sorted[LIDAR_FILTER_MEDIAN_SIZE];
+    uint8_t n = filter->count;
+    
+    for (uint8_t i = 0; i < n; i++) {
+        uint16_t value = filter->window[i];
+        uint8_t j = i;
+        
+        while (j > 0 && sorted[j - 1] > value) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = value;
+    }
+    
+    return sorted[n / 2];
+}
+
+/**
+ * @brief Runs one LIDAR frame through the filter.
+ * Frames with a weak signal or an out of range distance are rejected before
+ * they reach the median window.
+ *
+ * @param filter Filter state.
+ * @param frame Decoded LIDAR frame.
+ * @param[out] distance Filtered distance in cm, written only when 1 is returned.
+ * @return 1 if the frame was accepted and a filtered distance is available, 0 if it was rejected.
+ */
+uint8_t lidar_filter_update(lidar_filter_t *filter, const lidar_frame_t *frame, uint16_t *distance) {
+    uint16_t median;
+    
+    // TFMini-S reports strength 65535 when the receiver is saturated
+    if (frame->strength < LIDAR_FILTER_MIN_STRENGTH || frame->strength == 0xFFFF ||
+        frame->distance == 0 || frame->distance > LIDAR_FILTER_MAX_DISTANCE) {
+        filter->rejected++;
+        return 0;
+    }
+    
+    // Add the sample to the median window
+    filter->window[filter->index] = frame->distance;
+    if (++filter->index == LIDAR_FILTER_MEDIAN_SIZE) {
+        filter->index = 0;
+    }
+    if (filter->count < LIDAR_FILTER_MEDIAN_SIZE) {
+        filter->count++;
+    }
+    
+    median = lidar_filter_median(filter);
+    
+    // Exponential moving average, seeded with the first median
+    if (filter->count == 1) {
+        filter->ema = median << LIDAR_FILTER_FRAC_BITS;
+    } else {
+        int16_t error = (int16_t)((median << LIDAR_FILTER_FRAC_BITS) - filter->ema);
+        filter->ema += error >> LIDAR_FILTER_EMA_SHIFT;
+    }
+    
+    // Round to whole centimetres
+    *distance = (filter->ema + (1 << (LIDAR_FILTER_FRAC_BITS - 1))) >> LIDAR_FILTER_FRAC_BITS;
+    return 1;
+}
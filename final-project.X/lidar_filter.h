@@ -0,0 +1,73 @@
+/*
+ * File:   lidar_filter.h
+ * Author: chehj
+ *
+ * Description:
+ * Integer-only filtering of TFMini frames: signal strength and range rejection,
+ * a running median to remove single-frame spikes and an exponential moving
+ * average to smooth the result.
+ *
+ * Created on December 6, 2024, 4:10 PM
+ */
+
+#ifndef LIDAR_FILTER_H
+#define LIDAR_FILTER_H
+
+#include <stdint.h>
+#include "lidar.h"
+
+// Number of frames in the running median window (odd, at most 9)
+#ifndef LIDAR_FILTER_MEDIAN_SIZE
+#define LIDAR_FILTER_MEDIAN_SIZE 5
+#endif
+
+// EMA weight of a new sample is 1 / 2^LIDAR_FILTER_EMA_SHIFT
+#ifndef LIDAR_FILTER_EMA_SHIFT
+#define LIDAR_FILTER_EMA_SHIFT 2
+#endif
+
+// Frames with a weaker signal than this are unreliable and dropped
+#ifndef LIDAR_FILTER_MIN_STRENGTH
+#define LIDAR_FILTER_MIN_STRENGTH 100
+#endif
+
+// Maximum valid distance in cm (TFMini-S range is 12 m)
+#ifndef LIDAR_FILTER_MAX_DISTANCE
+#define LIDAR_FILTER_MAX_DISTANCE 1200
+#endif
+
+// Fractional bits kept in the EMA state
+#define LIDAR_FILTER_FRAC_BITS 4
+
+#if (LIDAR_FILTER_MEDIAN_SIZE % 2) == 0 || LIDAR_FILTER_MEDIAN_SIZE > 9
+#error "LIDAR_FILTER_MEDIAN_SIZE must be odd and at most 9"
+#endif
+
+// Filter state
+typedef struct {
+    uint16_t window[LIDAR_FILTER_MEDIAN_SIZE];  // Last accepted distances
+    uint8_t index;          // Next window slot to overwrite
+    uint8_t count;          // Number of valid samples in the window
+    uint16_t ema;           // Smoothed distance with LIDAR_FILTER_FRAC_BITS fraction bits
+    uint16_t rejected;      // Frames dropped for weak signal or bad range
+} lidar_filter_t;
+
+
+/**
+ * @brief Resets the filter state.
+ *
+ * @param filter Filter to reset.
+ */
+void lidar_filter_init(lidar_filter_t *filter);
+
+/**
+ * @brief Runs one LIDAR frame through the filter.
+ *
+ * @param filter Filter state.
+ * @param frame Decoded LIDAR frame.
+ * @param[out] distance Filtered distance in cm, written only when 1 is returned.
+ * @return 1 if the frame was accepted and a filtered distance is available, 0 if it was rejected.
+ */
+uint8_t lidar_filter_update(lidar_filter_t *filter, const lidar_frame_t *frame, uint16_t *distance);
+
+#endif /* LIDAR_FILTER_H */
@@ -1,152 +1,256 @@
-#include <avr/io.h>
-#include <stdlib.h>
-#include <string.h>
-#include <avr/cpufunc.h>
-#include <avr/interrupt.h>
-#include "RTC_Operations.h"
-#include "motor.h"
-#include "lidar.h"
-#include <inttypes.h>
-#include "gps.h"
-#include <util/delay.h>
-#include <stdbool.h>
-#include "printf.h"
-
-
-
-
-
-#define PULSE_LEFT 0x01
-#define PULSE_MIDDLE 0x02
-#define PULSE_RIGHT 0x04
-#define PULSE_CLOSER 0x08
-#define PULSE_FURTHER 0x10
-#define PULSE_ARRIVED 0x20
-
-#define DISTANCE_THRESHOLD 100
-
-volatile uint8_t statesActive = 0;
-volatile uint8_t pulseCounter = 0;
-volatile bool gps_data_ready = false; // Flag to indicate new GPS data is available
-volatile int secondCounter = 0;
-volatile bool threeSecondThreshold = false;
-
-ISR(RTC_CNT_vect) {
-    secondCounter++;
-    if (statesActive & PULSE_LEFT){
-        pulseLeft();     
-    }
-    if (statesActive & PULSE_RIGHT){
-        pulseRight(); 
-    }
-    
-    
-    if (statesActive & PULSE_CLOSER){
-        pulseCloser();  
-    }
-    
-    if (statesActive & PULSE_FURTHER){
-        pulseFurther();
-    }
-    
-    if (statesActive & PULSE_ARRIVED){
-        pulseArrived();
-    }
-    
-    if (statesActive & PULSE_DEST_CLOSER){
-        pulseRight();
-    }
-    if (statesActive & PULSE_DEST_FARTHER){
-        pulseLeft();
-    }
-    
-    // Every second
-    if (secondCounter == 2){
-        secondCounter = 0;
-        pulseCounter++;
-    }
-    
-    // Every three second
-    if (secondCounter == 6) {
-        threeSecondThreshold = true;
-    }
-    
-    if (pulseCounter > 6){
-        pulseCounter = 0;
-    }
-    
-    for (uint8_t x = 0; x < MAX_PACKET_SIZE; x++) {
-        if (x % 32 == 0) {
-            requestByte(32); // Request 32 bytes from the GPS module
-        }
-        uint8_t incoming = read(); // Read incoming byte from GPS
-
-        if (incoming != 0x0A) {  // Ignore line breaks
-            gpsData[_head++] = incoming; // Store the incoming byte in the gpsData buffer
-            _head %= MAX_PACKET_SIZE;  // Wrap head pointer if it exceeds MAX_PACKET_SIZE
-        }
-    }
-    
-    gps_data_ready = true; // Set flag to indicate new data is available
-    RTC.INTFLAGS = RTC_OVF_bm;
-    
-}
-int main() {
-    uint16_t distance;
-    uint16_t prev_distance;
-    
-    // Initialize UART
-    usartInit();
-    GPS_init(); 
-    RTC_init();
-  
-    // Configure LED pin (PA4) as output
-    PORTA.DIR |= PIN4_bm;
-    PORTA.DIR |= PIN5_bm;
-    PORTA.DIR |= PIN6_bm;
-    
-    sei();
-    
-    while (1) {
-        
-        // Try to read valid LIDAR data
-        if (statesActive & PULSE_ARRIVED)
-        {
-            
-        } else {
-            if (readLidarData(&distance)) {
-            // Update LED based on distance threshold
-            if (distance < DISTANCE_THRESHOLD) {
-                if (distance > prev_distance){
-                    USART2_PRINTF("Getting FURTHER TO AN OBJECT\r\n");
-                    statesActive |= PULSE_FURTHER;
-                    statesActive &= ~PULSE_CLOSER;
-                } else if (distance < prev_distance) {
-                    USART2_PRINTF("Getting CLOSER from an Object\r\n");
-                    statesActive |= PULSE_CLOSER;
-                    statesActive &= ~PULSE_FURTHER;
-                }
-
-                 
-            } else {
-                statesActive &= ~PULSE_CLOSER;
-                statesActive &= ~PULSE_FURTHER;
-                clearMotors();
-                pulseCounter = 0;
-
-            }
-            
-                prev_distance = distance;
-            }
-            // Calculate distance from destination every 3 seconds 
-            // secondCounter is actually a half second counter 
-           if ((secondCounter % 6) == 0) {
-              parse_gps_data(); // Parse GPS sentences in the main loop
-              threeSecondThreshold = false;
-        }
-        }
-    
-    }
-    
-    return 0;
-}
+#include <avr/io.h>
+#include <stdlib.h>
+#include <string.h>
+#include <avr/cpufunc.h>
+#include <avr/interrupt.h>
+#include "RTC_Operations.h"
+#include "motor.h"
+#include "haptic.h"
+#include "lidar.h"
+#include "lidar_filter.h"
+#include "ttc.h"
+#include <inttypes.h>
+#include "gps.h"
+#include <util/delay.h>
+#include <stdbool.h>
+#include "printf.h"
+#include "sched.h"
+
+
+
+
+
+#define PULSE_LEFT 0x01
+#define PULSE_MIDDLE 0x02
+#define PULSE_RIGHT 0x04
+#define PULSE_CLOSER 0x08
+#define PULSE_FURTHER 0x10
+#define PULSE_ARRIVED 0x20
+
+// Interval between triggered LIDAR measurements (ms)
+#define LIDAR_SAMPLE_PERIOD_MS 20
+
+volatile uint8_t statesActive = 0;
+volatile bool gps_data_ready = false; // Flag to indicate new GPS data is available
+
+// Pattern for each statesActive bit, lowest bit first
+static const haptic_pattern_t *const cuePatterns[8] = {
+    &hapticLeft,    // PULSE_LEFT
+    &hapticMiddle,  // PULSE_MIDDLE
+    &hapticRight,   // PULSE_RIGHT
+    &hapticCloser,  // PULSE_CLOSER
+    &hapticFurther, // PULSE_FURTHER
+    &hapticArrived, // PULSE_ARRIVED
+    &hapticLeft,    // PULSE_DEST_FARTHER
+    &hapticRight,   // PULSE_DEST_CLOSER
+};
+
+// statesActive bits belonging to each haptic cue class
+static const uint8_t cueClassBits[HAPTIC_CLASSES] = {
+    PULSE_CLOSER | PULSE_FURTHER,                                                       // HAPTIC_OBSTACLE
+    PULSE_ARRIVED,                                                                      // HAPTIC_ARRIVAL
+    PULSE_LEFT | PULSE_MIDDLE | PULSE_RIGHT | PULSE_DEST_CLOSER | PULSE_DEST_FARTHER,   // HAPTIC_NAVIGATION
+};
+static uint8_t hapticCue[HAPTIC_CLASSES];   // statesActive bit requested for each class, 0 if none
+
+// Obstacle pipeline state, shared by the LIDAR intake and obstacle tasks
+static lidar_filter_t lidarFilter;
+static ttc_t obstacle;
+static uint8_t obstacleState = TTC_CLEAR;
+static uint8_t lidarTriggerMode;
+static uint32_t lastTrigger = 0;
+static uint16_t lidarDistance;          // Latest filtered distance (cm)
+static uint32_t lidarTime;              // Timestamp of the frame it came from (ms)
+static bool lidarSampleReady = false;   // lidarDistance has not been handed to the obstacle task yet
+
+static void task_lidar(void);
+static void task_obstacle(void);
+static void task_gps(void);
+static void task_navigation(void);
+static void task_haptics(void);
+static void task_telemetry(void);
+
+// Main loop tasks, lower priority value runs first
+static sched_task_t tasks[] = {
+    //          name     entry            period  deadline  priority (ms)
+    SCHED_TASK("lidar", task_lidar,           5,        5,  0),
+    SCHED_TASK("obst",  task_obstacle,       10,       10,  1),
+    SCHED_TASK("haptic", task_haptics,       10,       10,  2),
+    SCHED_TASK("gps",   task_gps,            10,       50,  3),
+    SCHED_TASK("nav",   task_navigation,    100,      200,  4),
+    SCHED_TASK("telem", task_telemetry,    1000,     1000,  5),
+};
+#define TASK_COUNT (sizeof(tasks) / sizeof(tasks[0]))
+
+ISR(RTC_CNT_vect) {
+    RTC_PROFILE_START();
+    rtcOverflows++;
+    RTC.INTFLAGS = RTC_OVF_bm; // Cleared first so RTC_getMillis() is consistent in here
+    RTC_PROFILE_END();
+}
+
+// Triggers measurements and filters incoming LIDAR frames
+static void task_lidar(void) {
+    lidar_frame_t frame;
+    
+    if (lidarTriggerMode && RTC_elapsed(lastTrigger) >= LIDAR_SAMPLE_PERIOD_MS) {
+        lastTrigger = RTC_getMillis();
+        lidar_trigger();
+    }
+    
+    // Check for a complete LIDAR frame without blocking
+    if (lidar_poll(&frame) && lidar_filter_update(&lidarFilter, &frame, &lidarDistance)) {
+        lidarTime = frame.timestamp;
+        lidarSampleReady = true;
+    }
+}
+
+// Turns filtered distances into obstacle alerts, in every navigation state
+static void task_obstacle(void) {
+    uint8_t state;
+    
+    if (lidarSampleReady) {
+        lidarSampleReady = false;
+        
+        // Stronger vibration the closer the object is
+        haptic_set_intensity(HAPTIC_OBSTACLE, haptic_proximity(lidarDistance));
+        
+        // Alert on time to collision rather than on raw distance
+        state = ttc_update(&obstacle, lidarDistance, lidarTime);
+    } else if (ttc_expire(&obstacle, RTC_getMillis())) {
+        // No usable return for a while, e.g. turned towards open space.
+        // Restart the filter too so its window does not replay the old object.
+        lidar_filter_init(&lidarFilter);
+        state = TTC_CLEAR;
+    } else {
+        return;
+    }
+    
+    if (state == obstacleState) {
+        return;
+    }
+    
+    if (state == TTC_APPROACHING) {
+        USART2_PRINTF("Getting CLOSER from an Object\r\n");
+        statesActive |= PULSE_CLOSER;
+        statesActive &= ~PULSE_FURTHER;
+    } else if (state == TTC_RECEDING) {
+        USART2_PRINTF("Getting FURTHER TO AN OBJECT\r\n");
+        statesActive |= PULSE_FURTHER;
+        statesActive &= ~PULSE_CLOSER;
+    } else {
+        statesActive &= ~PULSE_CLOSER;
+        statesActive &= ~PULSE_FURTHER;
+    }
+    obstacleState = state;
+}
+
+// Keeps the background GPS reads going
+static void task_gps(void) {
+    gps_service();
+}
+
+// Parses new GPS data and refreshes guidance between fixes
+static void task_navigation(void) {
+    parse_gps_data();
+    gps_predict();
+}
+
+// Hands the active cues to the haptic arbiter and retires finished ones
+static void task_haptics(void) {
+    for (uint8_t cls = 0; cls < HAPTIC_CLASSES; cls++) {
+        const haptic_pattern_t *pattern = 0;
+        uint8_t bits;
+        
+        if (haptic_finished(cls)) {
+            statesActive &= ~hapticCue[cls]; // Pattern played out, clear only this cue
+        }
+        
+        // First active cue of the class, withdrawn if there is none
+        bits = statesActive & cueClassBits[cls];
+        hapticCue[cls] = 0;
+        for (uint8_t i = 0; i < 8; i++) {
+            if (bits & (1 << i)) {
+                hapticCue[cls] = 1 << i;
+                pattern = cuePatterns[i];
+                break;
+            }
+        }
+        haptic_request(cls, pattern);
+    }
+    
+    haptic_update();
+}
+
+// Prints one status line per run so no run holds the UART for long
+static void task_telemetry(void) {
+    static uint8_t line = 0;
+    
+    if (line < TASK_COUNT) {
+        sched_task_t *task = &tasks[line];
+        USART2_PRINTF_MOD("Task %s: %u runs, %u missed, last %lu us, max %lu us\r\n",
+                          task->name, task->runs, task->misses, task->lastRuntime, task->maxRuntime);
+    } else if (line == TASK_COUNT) {
+        USART2_PRINTF_MOD("RTC ISR max: %lu us\r\n",
+                          (uint32_t)rtcIsrMaxCycles * 1000000UL / F_CPU);
+    } else if (line == TASK_COUNT + 1) {
+        USART2_PRINTF_MOD("GPS I2C: %lu of %lu bytes useful, poll %u ms, %u burst timeouts\r\n",
+                          gpsUsefulBytes, gpsBytesRead, gpsPollInterval, gpsBurstTimeouts);
+    } else if (line == TASK_COUNT + 2) {
+        USART2_PRINTF_MOD("GPS rejected: %u no fix, %u quality, %u satellites, %u HDOP\r\n",
+                          gpsRejected.noFix, gpsRejected.lowQuality,
+                          gpsRejected.fewSatellites, gpsRejected.highHdop);
+    } else if (line == TASK_COUNT + 3) {
+        USART2_PRINTF_MOD("UART: %lu debug bytes dropped, %u LIDAR bytes overflowed\r\n",
+                          usart2TxDropped, usartRxOverflows);
+    } else if (line == TASK_COUNT + 4) {
+        USART2_PRINTF_MOD("Geometry cycles: plane %u project, %u distance, %u bearing; haversine %u, bearing %u\r\n",
+                          gpsGeoCycles.project, gpsGeoCycles.distance, gpsGeoCycles.bearing,
+                          gpsGeoCycles.haversine, gpsGeoCycles.greatCircle);
+    } else {
+        USART2_PRINTF_MOD("Haptic onset max: %u ms obstacle, %u ms arrival, %u ms navigation, %u preempted\r\n",
+                          hapticOnsetMax[HAPTIC_OBSTACLE], hapticOnsetMax[HAPTIC_ARRIVAL],
+                          hapticOnsetMax[HAPTIC_NAVIGATION], hapticPreemptions);
+    }
+    
+    if (++line > TASK_COUNT + 5) {
+        line = 0;
+    }
+}
+
+int main() {
+    // Initialize UART
+    usartInit();
+    lidar_parser_init(&lidarParser);
+    lidar_filter_init(&lidarFilter);
+    ttc_init(&obstacle);
+    GPS_init(); 
+    RTC_init();
+    RTC_profileInit();
+    gps_profile_geo();
+  
+    // Configure the motor pins (PA4 - PA6) and start the pattern sequencer
+    haptic_init();
+    
+    sei();
+    
+    // Switch the LIDAR to cm output and single-shot trigger mode so it only
+    // measures as often as the obstacle logic needs. If the sensor does not
+    // acknowledge, keep using its free-running stream.
+    lidarTriggerMode = lidar_set_output_format(LIDAR_FORMAT_CM) && lidar_set_frame_rate(0);
+    if (!lidarTriggerMode) {
+        USART2_PRINTF("LIDAR configuration failed, using default stream\r\n");
+    }
+    
+    // Only ask the GPS for the sentences the parser uses
+    if (!gps_configure()) {
+        USART2_PRINTF("GPS configuration failed, using default sentences\r\n");
+    }
+    
+    sched_init(tasks, TASK_COUNT, RTC_getMillis());
+    while (1) {
+        sched_run(tasks, TASK_COUNT);
+    }
+    
+    return 0;
+}
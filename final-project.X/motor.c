@@ -1,164 +1,131 @@
-/*
- * File:   motor.c
- * Author: chehj
- *
- * Created on December 1, 2024, 8:53 PM
- */
-
-#include "motor.h"
-
-// Define motor pulse states for readability and state management
-#define PULSE_LEFT    0x01
-#define PULSE_MIDDLE  0x02
-#define PULSE_RIGHT   0x04
-#define PULSE_CLOSER  0x08
-#define PULSE_FURTHER 0x10
-#define PULSE_ARRIVED 0x20
-#define PULSE_DEST_FARTHER 0x40
-#define PULSE_DEST_CLOSER 0x80
-
-/**
- * @brief Initialize motor control pins as outputs.
- * Sets the appropriate pins for left, middle, and right motors as outputs
- * to enable control.
- */
-void initMotors() {
-    PORTA.DIR |= LEFT_MOTOR;   // Set the left motor pin as output
-    PORTA.DIR |= MIDDLE_MOTOR; // Set the middle motor pin as output
-    PORTA.DIR |= RIGHT_MOTOR;  // Set the right motor pin as output
-}
-
-/**
- * @brief Clear motor states.
- * Turns off all motors by resetting their output pins.
- */
-void clearMotors() {
-    PORTA.OUT &= ~LEFT_MOTOR;   // Turn off the left motor
-    PORTA.OUT &= ~MIDDLE_MOTOR; // Turn off the middle motor
-    PORTA.OUT &= ~RIGHT_MOTOR;  // Turn off the right motor
-}
-
-/**
- * @brief Pulse the left motor with specific timing logic.
- * Alternates between activating the left and middle motors based on the 
- * value of `secondCounter` for 3 pulses.
- */
-void pulseLeft() {
-    if (pulseCounter < 3) {
-        if (secondCounter == 1) {
-            PORTA.OUT &= ~LEFT_MOTOR;
-            PORTA.OUT |= MIDDLE_MOTOR;  // Activate middle motor
-            PORTA.OUT &= ~RIGHT_MOTOR;
-        } else if (secondCounter == 2) {
-            PORTA.OUT |= LEFT_MOTOR;   // Activate left motor
-            PORTA.OUT &= ~MIDDLE_MOTOR;
-            PORTA.OUT &= ~RIGHT_MOTOR;
-        }
-    } else {
-        pulseCounter = 0;             // Reset pulse counter
-        statesActive &= ~PULSE_LEFT;  // Clear the pulse left state
-        clearMotors();
-    }
-}
-
-/**
- * @brief Pulse the middle motor with specific timing logic.
- * Alternates the middle motor activity, turning it on or off for 3 pulses.
- */
-void pulseMiddle() {
-    if (pulseCounter < 3) {
-        if (secondCounter == 1) {
-            PORTA.OUT &= ~LEFT_MOTOR;
-            PORTA.OUT |= MIDDLE_MOTOR; // Activate middle motor
-            PORTA.OUT &= ~RIGHT_MOTOR;
-        } else if (secondCounter == 2) {
-            PORTA.OUT &= ~LEFT_MOTOR;
-            PORTA.OUT &= ~MIDDLE_MOTOR; // Deactivate middle motor
-            PORTA.OUT &= ~RIGHT_MOTOR;
-        }
-    } else {
-        pulseCounter = 0;              // Reset pulse counter
-        statesActive &= ~PULSE_LEFT;   // Clear the pulse left state
-        clearMotors();
-    }
-}
-
-/**
- * @brief Pulse the right motor with specific timing logic.
- * Alternates between activating the right and middle motors for 3 pulses.
- */
-void pulseRight() {
-    if (pulseCounter < 3) {
-        if (secondCounter == 1) {
-            PORTA.OUT &= ~LEFT_MOTOR;
-            PORTA.OUT |= MIDDLE_MOTOR; // Activate middle motor
-            PORTA.OUT &= ~RIGHT_MOTOR;
-        } else if (secondCounter == 2) {
-            PORTA.OUT &= ~LEFT_MOTOR;
-            PORTA.OUT &= ~MIDDLE_MOTOR;
-            PORTA.OUT |= RIGHT_MOTOR; // Activate right motor
-        }
-    } else {
-        pulseCounter = 0;              // Reset pulse counter
-        statesActive &= ~PULSE_LEFT;   // Clear the pulse left state
-        clearMotors();
-    }
-}
-
-/**
- * @brief Pulse motors in a "closer" pattern.
- * Alternates between activating the left/right motors together and the middle motor alone.
- */
-void pulseCloser() {
-    if (pulseCounter < 3) {
-        PORTA.OUT |= LEFT_MOTOR;      // Activate left motor
-        PORTA.OUT &= ~MIDDLE_MOTOR;   // Deactivate middle motor
-        PORTA.OUT |= RIGHT_MOTOR;     // Activate right motor
-    } else if (pulseCounter == 3) {
-        PORTA.OUT &= ~LEFT_MOTOR;     // Deactivate left motor
-        PORTA.OUT |= MIDDLE_MOTOR;    // Activate middle motor
-        PORTA.OUT &= ~RIGHT_MOTOR;    // Deactivate right motor
-    } else {
-        pulseCounter = 0;             // Reset pulse counter
-        statesActive &= ~PULSE_LEFT;  // Clear the pulse left state
-        clearMotors();
-    }
-}
-
-/**
- * @brief Pulse motors in a "further" pattern.
- * Alternates between activating the middle motor and the left/right motors together.
- */
-void pulseFurther() {
-    if (pulseCounter < 3) {
-        PORTA.OUT &= ~LEFT_MOTOR;    // Deactivate left motor
-        PORTA.OUT |= MIDDLE_MOTOR;   // Activate middle motor
-        PORTA.OUT &= ~RIGHT_MOTOR;   // Deactivate right motor
-    } else if (pulseCounter == 3) {
-        PORTA.OUT |= LEFT_MOTOR;     // Activate left motor
-        PORTA.OUT &= ~MIDDLE_MOTOR;  // Deactivate middle motor
-        PORTA.OUT |= RIGHT_MOTOR;    // Activate right motor
-    } else {
-        pulseCounter = 0;            // Reset pulse counter
-        statesActive &= ~PULSE_LEFT; // Clear the pulse left state
-        clearMotors();
-    }
-}
-
-
-void pulseArrived(){
-    if ((pulseCounter < 4) & (secondCounter == 1)){
-        PORTA.OUT |= LEFT_MOTOR;
-        PORTA.OUT |= MIDDLE_MOTOR;
-        PORTA.OUT |= RIGHT_MOTOR;
-
-    } else if ((pulseCounter < 4) & (secondCounter == 2)){
-        PORTA.OUT &= ~LEFT_MOTOR;
-        PORTA.OUT &= ~MIDDLE_MOTOR;
-        PORTA.OUT &= ~RIGHT_MOTOR; 
-    }else {
-        pulseCounter = 0;
-        statesActive &= ~PULSE_ARRIVED;
-        clearMotors();
-    }
-}
+/*
+ * File:   motor.c
+ * Author: chehj
+ *
+ * Created on December 1, 2024, 8:53 PM
+ */
+
+#include <avr/interrupt.h>
+#include "motor.h"
+
+// PWM level of each motor while it is on
+static uint8_t motorIntensity[3] = { MOTOR_FULL, MOTOR_FULL, MOTOR_FULL };
+
+// Right motor is on, its software PWM runs from the TCA0 low counter
+static volatile uint8_t motorSoftOn = 0;
+
+/**
+ * @brief Initialize motor control pins as outputs.
+ * Sets the appropriate pins for left, middle, and right motors as outputs
+ * to enable control, and starts TCA0 in split mode: the high counter drives
+ * the left and middle motors in hardware (WO4 on PA4, WO5 on PA5), the low
+ * counter times the software PWM of the right motor on PA6, which has no
+ * TCA0 output. WO3 stays off, PA3 is the I2C clock.
+ */
+void initMotors() {
+    PORTA.OUT &= ~ALL_MOTORS;  // Pins are low while their PWM output is off
+    PORTA.DIR |= LEFT_MOTOR;   // Set the left motor pin as output
+    PORTA.DIR |= MIDDLE_MOTOR; // Set the middle motor pin as output
+    PORTA.DIR |= RIGHT_MOTOR;  // Set the right motor pin as output
+
+    PORTMUX.TCAROUTEA = PORTMUX_TCA0_PORTA_gc; // WO0 - WO5 on PA0 - PA5
+
+    TCA0.SPLIT.CTRLA = 0;
+    TCA0.SPLIT.CTRLESET = TCA_SPLIT_CMD_RESET_gc;
+    TCA0.SPLIT.CTRLD = TCA_SPLIT_SPLITM_bm;
+    TCA0.SPLIT.HPER = 0xFF;
+    TCA0.SPLIT.LPER = 0xFF;
+    TCA0.SPLIT.HCMP1 = motorIntensity[0];
+    TCA0.SPLIT.HCMP2 = motorIntensity[1];
+    TCA0.SPLIT.LCMP0 = motorIntensity[2];
+    TCA0.SPLIT.CTRLB = 0; // All outputs off until setMotors()
+    TCA0.SPLIT.CTRLA = MOTOR_PWM_CLKSEL | TCA_SPLIT_ENABLE_bm;
+}
+
+/**
+ * @brief Clear motor states.
+ * Turns off all motors by resetting their output pins.
+ */
+void clearMotors() {
+    setMotors(0);
+}
+
+/**
+ * @brief Switch the motors to a new combination.
+ * The left and middle motors change with a single write of the TCA0 output
+ * enables; the right motor's software PWM is started or stopped with them.
+ * A motor at intensity 0 stays off.
+ *
+ * @param motors Mask of LEFT_MOTOR, MIDDLE_MOTOR and RIGHT_MOTOR to turn on.
+ */
+void setMotors(uint8_t motors) {
+    uint8_t outputs = 0;
+
+    if ((motors & LEFT_MOTOR) && motorIntensity[0]) {
+        outputs |= TCA_SPLIT_HCMP1EN_bm;
+    }
+    if ((motors & MIDDLE_MOTOR) && motorIntensity[1]) {
+        outputs |= TCA_SPLIT_HCMP2EN_bm;
+    }
+    TCA0.SPLIT.CTRLB = outputs;
+
+    motorSoftOn = (motors & RIGHT_MOTOR) && motorIntensity[2];
+    if (motorSoftOn) {
+        TCA0.SPLIT.INTCTRL = TCA_SPLIT_LUNF_bm | TCA_SPLIT_LCMP0_bm;
+    } else {
+        TCA0.SPLIT.INTCTRL = 0;
+        VPORTA.OUT &= ~RIGHT_MOTOR;
+    }
+}
+
+/**
+ * @brief Set the PWM level of one or more motors.
+ * Takes effect within one PWM period, whether the motor is on or off.
+ * Intensity 0 stops the right motor's software PWM until the next
+ * setMotors(), as setMotors() leaves a motor at 0 off; other values are
+ * raised to MOTOR_SOFT_MIN so the LCMP0 interrupt always precedes LUNF.
+ *
+ * @param motors Mask of LEFT_MOTOR, MIDDLE_MOTOR and RIGHT_MOTOR.
+ * @param intensity Duty cycle, 0 (off) to MOTOR_FULL.
+ */
+void setMotorIntensity(uint8_t motors, uint8_t intensity) {
+    if (motors & LEFT_MOTOR) {
+        motorIntensity[0] = intensity;
+        TCA0.SPLIT.HCMP1 = intensity;
+    }
+    if (motors & MIDDLE_MOTOR) {
+        motorIntensity[1] = intensity;
+        TCA0.SPLIT.HCMP2 = intensity;
+    }
+    if (motors & RIGHT_MOTOR) {
+        motorIntensity[2] = intensity;
+        if (intensity == 0) {
+            // A match at BOTTOM would run after the underflow and leave the pin on
+            motorSoftOn = 0;
+            TCA0.SPLIT.INTCTRL = 0;
+            VPORTA.OUT &= ~RIGHT_MOTOR;
+        } else {
+            TCA0.SPLIT.LCMP0 = (intensity < MOTOR_SOFT_MIN) ? MOTOR_SOFT_MIN : intensity;
+        }
+    }
+}
+
+/**
+ * @brief TCA0 low counter compare, starts the right motor's on time.
+ * Matches the hardware channels: the output is set on compare match while
+ * counting down and cleared at BOTTOM, so the duty is LCMP0 / 256.
+ */
+ISR(TCA0_LCMP0_vect) {
+    TCA0.SPLIT.INTFLAGS = TCA_SPLIT_LCMP0_bm;
+    if (motorSoftOn) {
+        VPORTA.OUT |= RIGHT_MOTOR;
+    }
+}
+
+/**
+ * @brief TCA0 low counter underflow, ends the right motor's on time.
+ */
+ISR(TCA0_LUNF_vect) {
+    TCA0.SPLIT.INTFLAGS = TCA_SPLIT_LUNF_bm;
+    VPORTA.OUT &= ~RIGHT_MOTOR;
+}
@@ -1,66 +1,66 @@
-/*
- * File:   motor.h
- * Author: chehj
- *
- * Created on December 1, 2024, 8:53 PM
- */
-
-#ifndef MOTOR_H
-#define MOTOR_H
-
-
-#include <avr/io.h> // For PORTA register definitions
-
-// Motor Pins
-#define LEFT_MOTOR PIN4_bm
-#define MIDDLE_MOTOR PIN5_bm
-#define RIGHT_MOTOR PIN6_bm
-
-
-// External Variables
-extern volatile uint8_t pulseCounter;
-extern volatile int  secondCounter;
-extern volatile uint8_t statesActive;
-
-
-/**
- * @brief Initializes motor pins as output.
- */
-void initMotors(void);
-
-/**
- * @brief Clears all motor control signals.
- */
-void clearMotors(void);
-
-/**
- * @brief Generates a pulse sequence for the left motor.
- */
-void pulseLeft(void);
-
-/**
- * @brief Generates a pulse sequence for the middle motor.
- */
-void pulseMiddle(void);
-
-/**
- * @brief Generates a pulse sequence for the right motor.
- */
-void pulseRight(void);
-
-/**
- * @brief Generates a pulse sequence for both left and right motors (closer).
- */
-void pulseCloser(void);
-
-/**
- * @brief Generates a pulse sequence for the middle motor and alternating left and right motors (further).
- */
-void pulseFurther(void);
-
-/**
- * @brief Generates a pulse sequence for the all three motors when arrived at destination.
- */
-void pulseArrived(void);
-
-#endif /* MOTOR_H */
+/*
+ * File:   motor.h
+ * Author: chehj
+ *
+ * Created on December 1, 2024, 8:53 PM
+ */
+
+#ifndef MOTOR_H
+#define MOTOR_H
+
+
+#include <avr/io.h> // For PORTA and VPORTA register definitions
+
+// Motor Pins
+#define LEFT_MOTOR PIN4_bm
+#define MIDDLE_MOTOR PIN5_bm
+#define RIGHT_MOTOR PIN6_bm
+#define ALL_MOTORS (LEFT_MOTOR | MIDDLE_MOTOR | RIGHT_MOTOR)
+
+// Full intensity (duty 255/256)
+#define MOTOR_FULL 255
+
+// Smallest software PWM duty of the right motor, in counts. The LCMP0 match
+// must come well before BOTTOM so its interrupt runs before the underflow.
+#ifndef MOTOR_SOFT_MIN
+#define MOTOR_SOFT_MIN 8
+#endif
+
+// TCA0 prescaler: 3.33 MHz / 16 / 256 gives ~810 Hz PWM
+#ifndef MOTOR_PWM_CLKSEL
+#define MOTOR_PWM_CLKSEL TCA_SPLIT_CLKSEL_DIV16_gc
+#endif
+
+
+/**
+ * @brief Initializes motor pins as output and starts the TCA0 PWM.
+ * PA4 and PA5 are driven by TCA0 in split mode; PA6 has no TCA0 output, so
+ * it gets a software PWM from the TCA0 low counter interrupts.
+ */
+void initMotors(void);
+
+/**
+ * @brief Clears all motor control signals.
+ * Call with interrupts masked while the haptic sequencer is running.
+ */
+void clearMotors(void);
+
+/**
+ * @brief Turns on exactly the given motors, each at its intensity.
+ * Call with interrupts masked while the haptic sequencer is running.
+ *
+ * @param motors Mask of LEFT_MOTOR, MIDDLE_MOTOR and RIGHT_MOTOR.
+ */
+void setMotors(uint8_t motors);
+
+/**
+ * @brief Sets the PWM level of one or more motors.
+ * The right motor's software PWM stops at 0 and runs at no less than
+ * MOTOR_SOFT_MIN counts otherwise.
+ *
+ * @param motors Mask of LEFT_MOTOR, MIDDLE_MOTOR and RIGHT_MOTOR.
+ * @param intensity Duty cycle, 0 (off) to MOTOR_FULL.
+ */
+void setMotorIntensity(uint8_t motors, uint8_t intensity);
+
+#endif /* MOTOR_H */
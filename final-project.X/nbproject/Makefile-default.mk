@@ -51,17 +51,17 @@ OBJECTDIR=build/${CND_CONF}/${IMAGE_TYPE}
 DISTDIR=dist/${CND_CONF}/${IMAGE_TYPE}
 
 # Source Files Quoted if spaced
-SOURCEFILES_QUOTED_IF_SPACED=printf.c gps.c i2c.c RTC_operations.c main.c usart.c lidar.c motor.c
+SOURCEFILES_QUOTED_IF_SPACED=printf.c gps.c i2c.c RTC_operations.c main.c usart.c lidar.c motor.c lidar_filter.c ttc.c nmea.c geo.c route.c guidance.c track.c sched.c ring.c haptic.c
 
 # Object Files Quoted if spaced
-OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/printf.o ${OBJECTDIR}/gps.o ${OBJECTDIR}/i2c.o ${OBJECTDIR}/RTC_operations.o ${OBJECTDIR}/main.o ${OBJECTDIR}/usart.o ${OBJECTDIR}/lidar.o ${OBJECTDIR}/motor.o
-POSSIBLE_DEPFILES=${OBJECTDIR}/printf.o.d ${OBJECTDIR}/gps.o.d ${OBJECTDIR}/i2c.o.d ${OBJECTDIR}/RTC_operations.o.d ${OBJECTDIR}/main.o.d ${OBJECTDIR}/usart.o.d ${OBJECTDIR}/lidar.o.d ${OBJECTDIR}/motor.o.d
+OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/printf.o ${OBJECTDIR}/gps.o ${OBJECTDIR}/i2c.o ${OBJECTDIR}/RTC_operations.o ${OBJECTDIR}/main.o ${OBJECTDIR}/usart.o ${OBJECTDIR}/lidar.o ${OBJECTDIR}/motor.o ${OBJECTDIR}/lidar_filter.o ${OBJECTDIR}/ttc.o ${OBJECTDIR}/nmea.o ${OBJECTDIR}/geo.o ${OBJECTDIR}/route.o ${OBJECTDIR}/guidance.o ${OBJECTDIR}/track.o ${OBJECTDIR}/sched.o ${OBJECTDIR}/ring.o ${OBJECTDIR}/haptic.o
+POSSIBLE_DEPFILES=${OBJECTDIR}/printf.o.d ${OBJECTDIR}/gps.o.d ${OBJECTDIR}/i2c.o.d ${OBJECTDIR}/RTC_operations.o.d ${OBJECTDIR}/main.o.d ${OBJECTDIR}/usart.o.d ${OBJECTDIR}/lidar.o.d ${OBJECTDIR}/motor.o.d ${OBJECTDIR}/lidar_filter.o.d ${OBJECTDIR}/ttc.o.d ${OBJECTDIR}/nmea.o.d ${OBJECTDIR}/geo.o.d ${OBJECTDIR}/route.o.d ${OBJECTDIR}/guidance.o.d ${OBJECTDIR}/track.o.d ${OBJECTDIR}/sched.o.d ${OBJECTDIR}/ring.o.d ${OBJECTDIR}/haptic.o.d
 
 # Object Files
-OBJECTFILES=${OBJECTDIR}/printf.o ${OBJECTDIR}/gps.o ${OBJECTDIR}/i2c.o ${OBJECTDIR}/RTC_operations.o ${OBJECTDIR}/main.o ${OBJECTDIR}/usart.o ${OBJECTDIR}/lidar.o ${OBJECTDIR}/motor.o
+OBJECTFILES=${OBJECTDIR}/printf.o ${OBJECTDIR}/gps.o ${OBJECTDIR}/i2c.o ${OBJECTDIR}/RTC_operations.o ${OBJECTDIR}/main.o ${OBJECTDIR}/usart.o ${OBJECTDIR}/lidar.o ${OBJECTDIR}/motor.o ${OBJECTDIR}/lidar_filter.o ${OBJECTDIR}/ttc.o ${OBJECTDIR}/nmea.o ${OBJECTDIR}/geo.o ${OBJECTDIR}/route.o ${OBJECTDIR}/guidance.o ${OBJECTDIR}/track.o ${OBJECTDIR}/sched.o ${OBJECTDIR}/ring.o ${OBJECTDIR}/haptic.o
 
 # Source Files
-SOURCEFILES=printf.c gps.c i2c.c RTC_operations.c main.c usart.c lidar.c motor.c
+SOURCEFILES=printf.c gps.c i2c.c RTC_operations.c main.c usart.c lidar.c motor.c lidar_filter.c ttc.c nmea.c geo.c route.c guidance.c track.c sched.c ring.c haptic.c
 
 
 
@@ -136,6 +136,66 @@ ${OBJECTDIR}/motor.o: motor.c  .generated_files/flags/default/7219b22c436139eace
 	@${RM} ${OBJECTDIR}/motor.o 
 	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -fno-common -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/motor.o.d" -MT "${OBJECTDIR}/motor.o.d" -MT ${OBJECTDIR}/motor.o -o ${OBJECTDIR}/motor.o motor.c 
 	
+${OBJECTDIR}/lidar_filter.o: lidar_filter.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/lidar_filter.o.d 
+	@${RM} ${OBJECTDIR}/lidar_filter.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -fno-common -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/lidar_filter.o.d" -MT "${OBJECTDIR}/lidar_filter.o.d" -MT ${OBJECTDIR}/lidar_filter.o -o ${OBJECTDIR}/lidar_filter.o lidar_filter.c 
+	
+${OBJECTDIR}/ttc.o: ttc.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/ttc.o.d 
+	@${RM} ${OBJECTDIR}/ttc.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -fno-common -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/ttc.o.d" -MT "${OBJECTDIR}/ttc.o.d" -MT ${OBJECTDIR}/ttc.o -o ${OBJECTDIR}/ttc.o ttc.c 
+	
+${OBJECTDIR}/nmea.o: nmea.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/nmea.o.d 
+	@${RM} ${OBJECTDIR}/nmea.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -fno-common -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/nmea.o.d" -MT "${OBJECTDIR}/nmea.o.d" -MT ${OBJECTDIR}/nmea.o -o ${OBJECTDIR}/nmea.o nmea.c 
+	
+${OBJECTDIR}/geo.o: geo.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/geo.o.d 
+	@${RM} ${OBJECTDIR}/geo.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -fno-common -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/geo.o.d" -MT "${OBJECTDIR}/geo.o.d" -MT ${OBJECTDIR}/geo.o -o ${OBJECTDIR}/geo.o geo.c 
+	
+${OBJECTDIR}/route.o: route.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/route.o.d 
+	@${RM} ${OBJECTDIR}/route.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -fno-common -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/route.o.d" -MT "${OBJECTDIR}/route.o.d" -MT ${OBJECTDIR}/route.o -o ${OBJECTDIR}/route.o route.c 
+	
+${OBJECTDIR}/guidance.o: guidance.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/guidance.o.d 
+	@${RM} ${OBJECTDIR}/guidance.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -fno-common -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/guidance.o.d" -MT "${OBJECTDIR}/guidance.o.d" -MT ${OBJECTDIR}/guidance.o -o ${OBJECTDIR}/guidance.o guidance.c 
+	
+${OBJECTDIR}/track.o: track.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/track.o.d 
+	@${RM} ${OBJECTDIR}/track.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -fno-common -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/track.o.d" -MT "${OBJECTDIR}/track.o.d" -MT ${OBJECTDIR}/track.o -o ${OBJECTDIR}/track.o track.c 
+	
+${OBJECTDIR}/sched.o: sched.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/sched.o.d 
+	@${RM} ${OBJECTDIR}/sched.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -fno-common -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/sched.o.d" -MT "${OBJECTDIR}/sched.o.d" -MT ${OBJECTDIR}/sched.o -o ${OBJECTDIR}/sched.o sched.c 
+	
+${OBJECTDIR}/ring.o: ring.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/ring.o.d 
+	@${RM} ${OBJECTDIR}/ring.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -fno-common -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/ring.o.d" -MT "${OBJECTDIR}/ring.o.d" -MT ${OBJECTDIR}/ring.o -o ${OBJECTDIR}/ring.o ring.c 
+	
+${OBJECTDIR}/haptic.o: haptic.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/haptic.o.d 
+	@${RM} ${OBJECTDIR}/haptic.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -fno-common -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/haptic.o.d" -MT "${OBJECTDIR}/haptic.o.d" -MT ${OBJECTDIR}/haptic.o -o ${OBJECTDIR}/haptic.o haptic.c 
+	
 else
 ${OBJECTDIR}/printf.o: printf.c  .generated_files/flags/default/dffdfa6057eca985b40676efdf0ee3e31ac68b17 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}" 
@@ -185,6 +245,66 @@ ${OBJECTDIR}/motor.o: motor.c  .generated_files/flags/default/9082a9db366fd3051c
 	@${RM} ${OBJECTDIR}/motor.o 
 	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -fno-common -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/motor.o.d" -MT "${OBJECTDIR}/motor.o.d" -MT ${OBJECTDIR}/motor.o -o ${OBJECTDIR}/motor.o motor.c 
 	
+${OBJECTDIR}/lidar_filter.o: lidar_filter.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/lidar_filter.o.d 
+	@${RM} ${OBJECTDIR}/lidar_filter.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -fno-common -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/lidar_filter.o.d" -MT "${OBJECTDIR}/lidar_filter.o.d" -MT ${OBJECTDIR}/lidar_filter.o -o ${OBJECTDIR}/lidar_filter.o lidar_filter.c 
+	
+${OBJECTDIR}/ttc.o: ttc.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/ttc.o.d 
+	@${RM} ${OBJECTDIR}/ttc.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -fno-common -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/ttc.o.d" -MT "${OBJECTDIR}/ttc.o.d" -MT ${OBJECTDIR}/ttc.o -o ${OBJECTDIR}/ttc.o ttc.c 
+	
+${OBJECTDIR}/nmea.o: nmea.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/nmea.o.d 
+	@${RM} ${OBJECTDIR}/nmea.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -fno-common -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/nmea.o.d" -MT "${OBJECTDIR}/nmea.o.d" -MT ${OBJECTDIR}/nmea.o -o ${OBJECTDIR}/nmea.o nmea.c 
+	
+${OBJECTDIR}/geo.o: geo.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/geo.o.d 
+	@${RM} ${OBJECTDIR}/geo.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -fno-common -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/geo.o.d" -MT "${OBJECTDIR}/geo.o.d" -MT ${OBJECTDIR}/geo.o -o ${OBJECTDIR}/geo.o geo.c 
+	
+${OBJECTDIR}/route.o: route.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/route.o.d 
+	@${RM} ${OBJECTDIR}/route.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -fno-common -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/route.o.d" -MT "${OBJECTDIR}/route.o.d" -MT ${OBJECTDIR}/route.o -o ${OBJECTDIR}/route.o route.c 
+	
+${OBJECTDIR}/guidance.o: guidance.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/guidance.o.d 
+	@${RM} ${OBJECTDIR}/guidance.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -fno-common -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/guidance.o.d" -MT "${OBJECTDIR}/guidance.o.d" -MT ${OBJECTDIR}/guidance.o -o ${OBJECTDIR}/guidance.o guidance.c 
+	
+${OBJECTDIR}/track.o: track.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/track.o.d 
+	@${RM} ${OBJECTDIR}/track.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -fno-common -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/track.o.d" -MT "${OBJECTDIR}/track.o.d" -MT ${OBJECTDIR}/track.o -o ${OBJECTDIR}/track.o track.c 
+	
+${OBJECTDIR}/sched.o: sched.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/sched.o.d 
+	@${RM} ${OBJECTDIR}/sched.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -fno-common -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/sched.o.d" -MT "${OBJECTDIR}/sched.o.d" -MT ${OBJECTDIR}/sched.o -o ${OBJECTDIR}/sched.o sched.c 
+	
+${OBJECTDIR}/ring.o: ring.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/ring.o.d 
+	@${RM} ${OBJECTDIR}/ring.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -fno-common -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/ring.o.d" -MT "${OBJECTDIR}/ring.o.d" -MT ${OBJECTDIR}/ring.o -o ${OBJECTDIR}/ring.o ring.c 
+	
+${OBJECTDIR}/haptic.o: haptic.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/haptic.o.d 
+	@${RM} ${OBJECTDIR}/haptic.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -fno-common -funsigned-char -funsigned-bitfields -Wall -DXPRJ_default=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/haptic.o.d" -MT "${OBJECTDIR}/haptic.o.d" -MT ${OBJECTDIR}/haptic.o -o ${OBJECTDIR}/haptic.o haptic.c 
+	
 endif
 
 # ------------------------------------------------------------------------------------
@@ -0,0 +1,208 @@
+/*
+ * File:   nmea.c
+ * Author: chehj
+ *
+ * Created on December 8, 2024, 11:20 AM
+ */
+
+#include "nmea.h"
+#include <string.h>
+
+
+/**
+ * @brief Resets the lexer and registers the sentence handlers.
+ *
+ * @param lexer Lexer state.
+ * @param handlers Table of handlers, must stay valid while the lexer is used.
+ * @param count Number of handlers in the table.
+ */
+void nmea_init(nmea_lexer_t *lexer, const nmea_handler_t *handlers, uint8_t count) {
+    lexer->handlers = handlers;
+    lexer->handlerCount = count;
+    lexer->active = 0;
+    lexer->state = NMEA_STATE_IDLE;
+    lexer->sentences = 0;
+    lexer->checksumErrors = 0;
+    lexer->truncatedFields = 0;
+}
+
+/**
+ * @brief Finds the handler registered for the address field.
+ *
+ * @param lexer Lexer state.
+ * @return The matching handler, or NULL if the sentence is not registered.
+ */
+static const nmea_handler_t *nmea_match(const nmea_lexer_t *lexer) {
+    for (uint8_t i = 0; i < lexer->handlerCount; i++) {
+        const char *type = lexer->handlers[i].type;
+        uint8_t length = strlen(type);
+        
+        // Exact match, or match after a two-character talker ID
+        if ((lexer->fieldLength == length && memcmp(lexer->field, type, length) == 0) ||
+            (lexer->fieldLength == length + 2 && memcmp(lexer->field + 2, type, length) == 0)) {
+            return &lexer->handlers[i];
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Hands the completed field to the active handler.
+ *
+ * @param lexer Lexer state.
+ */
+static void nmea_end_field(nmea_lexer_t *lexer) {
+    lexer->field[lexer->fieldLength] = '\0';
+    
+    if (lexer->fieldIndex == 0) {
+        lexer->active = nmea_match(lexer);
+        if (lexer->active && lexer->active->begin) {
+            lexer->active->begin();
+        }
+    } else if (lexer->active) {
+        lexer->active->field(lexer->fieldIndex, lexer->field, lexer->fieldLength);
+    }
+    
+    lexer->fieldIndex++;
+    lexer->fieldLength = 0;
+    lexer->fieldTruncated = 0;
+}
+
+/**
+ * @brief Converts a hexadecimal digit.
+ *
+ * @param c Character to convert.
+ * @return The digit value, or 0xFF if c is not a hex digit.
+ */
+static uint8_t nmea_hex(uint8_t c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return 0xFF;
+}
+
+/**
+ * @brief Feeds one byte into the lexer.
+ * Bytes outside a sentence, including the GPS module's filler bytes, are
+ * ignored. A '$' always starts a new sentence, so a truncated sentence is
+ * simply abandoned.
+ *
+ * @param lexer Lexer state.
+ * @param c Next byte of the NMEA stream.
+ */
+void nmea_feed(nmea_lexer_t *lexer, uint8_t c) {
+    uint8_t digit;
+    
+    if (c == '$') {
+        lexer->state = NMEA_STATE_BODY;
+        lexer->checksum = 0;
+        lexer->fieldIndex = 0;
+        lexer->fieldLength = 0;
+        lexer->fieldTruncated = 0;
+        lexer->active = 0;
+        return;
+    }
+    
+    switch (lexer->state) {
+    case NMEA_STATE_BODY:
+        if (c == '*') {
+            nmea_end_field(lexer);
+            lexer->state = NMEA_STATE_CHECKSUM1;
+        } else if (c == '\r' || c == '\n') {
+            // Sentence ended without a checksum
+            if (lexer->active) {
+                lexer->checksumErrors++;
+            }
+            lexer->state = NMEA_STATE_IDLE;
+        } else {
+            lexer->checksum ^= c;
+            if (c == ',') {
+                nmea_end_field(lexer);
+            } else if (lexer->fieldIndex == 0 || lexer->active) {
+                // Only keep characters that someone will look at
+                if (lexer->fieldLength < NMEA_FIELD_SIZE - 1) {
+                    lexer->field[lexer->fieldLength++] = c;
+                } else if (!lexer->fieldTruncated) {
+                    lexer->fieldTruncated = 1;
+                    lexer->truncatedFields++;
+                }
+            }
+        }
+        break;
+        
+    case NMEA_STATE_CHECKSUM1:
+    case NMEA_STATE_CHECKSUM2:
+        digit = nmea_hex(c);
+        if (digit == 0xFF) {
+            if (lexer->active) {
+                lexer->checksumErrors++;
+            }
+            lexer->state = NMEA_STATE_IDLE;
+        } else if (lexer->state == NMEA_STATE_CHECKSUM1) {
+            lexer->received = digit << 4;
+            lexer->state = NMEA_STATE_CHECKSUM2;
+        } else {
+            lexer->received |= digit;
+            lexer->state = NMEA_STATE_IDLE;
+            if (lexer->active) {
+                if (lexer->received == lexer->checksum) {
+                    lexer->sentences++;
+                    lexer->active->commit();
+                } else {
+                    lexer->checksumErrors++;
+                }
+            }
+        }
+        break;
+        
+    default:
+        break;  // Outside a sentence
+    }
+}
+
+/**
+ * @brief Parses an unsigned decimal field, stopping at the first non-digit.
+ *
+ * @param text Field text.
+ * @param length Field length.
+ * @return The value, 0 for an empty field.
+ */
+uint32_t nmea_parse_uint(const char *text, uint8_t length) {
+    uint32_t value = 0;
+    
+    for (uint8_t i = 0; i < length && text[i] >= '0' && text[i] <= '9'; i++) {
+        value = value * 10 + (text[i] - '0');
+    }
+    return value;
+}
+
+/**
+ * @brief Parses a decimal field with a fraction as a fixed-point integer.
+ * "12.34" with 3 decimals gives 12340. Extra fraction digits are dropped.
+ *
+ * @param text Field text.
+ * @param length Field length.
+ * @param decimals Number of fraction digits in the result.
+ * @return The scaled value, 0 for an empty field.
+ */
+uint32_t nmea_parse_fixed(const char *text, uint8_t length, uint8_t decimals) {
+    uint32_t value = 0;
+    uint8_t i = 0;
+    
+    // Integer part
+    for (; i < length && text[i] >= '0' && text[i] <= '9'; i++) {
+        value = value * 10 + (text[i] - '0');
+    }
+    
+    // Fraction part, padded or cut to the requested number of digits
+    if (i < length && text[i] == '.') {
+        i++;
+    }
+    for (; decimals > 0; decimals--) {
+        value *= 10;
+        if (i < length && text[i] >= '0' && text[i] <= '9') {
+            value += text[i++] - '0';
+        }
+    }
+    return value;
+}
@@ -0,0 +1,97 @@
+/*
+ * File:   nmea.h
+ * Author: chehj
+ *
+ * Description:
+ * Streaming NMEA 0183 lexer. Bytes are fed one at a time; the lexer splits
+ * sentences into fields, computes the XOR checksum as the bytes arrive and
+ * hands fields only to the handlers registered for that sentence type.
+ * Handlers should treat fields as provisional until their commit callback
+ * runs, which only happens when the checksum matches.
+ *
+ * Created on December 8, 2024, 11:20 AM
+ */
+
+#ifndef NMEA_H
+#define NMEA_H
+
+#include <stdint.h>
+
+// Longest field kept, longer fields are truncated and flagged
+#define NMEA_FIELD_SIZE 16
+
+// Lexer states
+#define NMEA_STATE_IDLE 0       // Waiting for '$'
+#define NMEA_STATE_BODY 1       // Inside the sentence body
+#define NMEA_STATE_CHECKSUM1 2  // Expecting the first checksum digit
+#define NMEA_STATE_CHECKSUM2 3  // Expecting the second checksum digit
+
+/**
+ * @brief Handler for one sentence type.
+ * The type is matched against the address field either exactly (e.g.
+ * "PMTK001") or after the two-character talker ID (e.g. "GGA" matches
+ * "GNGGA" and "GPGGA").
+ */
+typedef struct {
+    const char *type;                   // Sentence type to match
+    void (*begin)(void);                // Sentence started, may be NULL
+    void (*field)(uint8_t index, const char *text, uint8_t length); // Field 1.. of the sentence
+    void (*commit)(void);               // Checksum verified
+} nmea_handler_t;
+
+// Lexer state
+typedef struct {
+    const nmea_handler_t *handlers;     // Registered sentence handlers
+    uint8_t handlerCount;
+    const nmea_handler_t *active;       // Handler of the current sentence, NULL if ignored
+    uint8_t state;                      // NMEA_STATE_* value
+    uint8_t checksum;                   // XOR of the bytes between '$' and '*'
+    uint8_t received;                   // Checksum digits received so far
+    uint8_t fieldIndex;                 // Index of the current field, 0 is the address
+    uint8_t fieldLength;                // Characters in the current field
+    uint8_t fieldTruncated;             // Current field did not fit in the buffer
+    char field[NMEA_FIELD_SIZE];        // Current field, NUL terminated when handed out
+    uint16_t sentences;                 // Registered sentences with a valid checksum
+    uint16_t checksumErrors;            // Registered sentences with a bad or missing checksum
+    uint16_t truncatedFields;           // Fields longer than NMEA_FIELD_SIZE - 1
+} nmea_lexer_t;
+
+
+/**
+ * @brief Resets the lexer and registers the sentence handlers.
+ *
+ * @param lexer Lexer state.
+ * @param handlers Table of handlers, must stay valid while the lexer is used.
+ * @param count Number of handlers in the table.
+ */
+void nmea_init(nmea_lexer_t *lexer, const nmea_handler_t *handlers, uint8_t count);
+
+/**
+ * @brief Feeds one byte into the lexer.
+ *
+ * @param lexer Lexer state.
+ * @param c Next byte of the NMEA stream.
+ */
+void nmea_feed(nmea_lexer_t *lexer, uint8_t c);
+
+/**
+ * @brief Parses an unsigned decimal field, stopping at the first non-digit.
+ *
+ * @param text Field text.
+ * @param length Field length.
+ * @return The value, 0 for an empty field.
+ */
+uint32_t nmea_parse_uint(const char *text, uint8_t length);
+
+/**
+ * @brief Parses a decimal field with a fraction as a fixed-point integer.
+ * "12.34" with 3 decimals gives 12340. Extra fraction digits are dropped.
+ *
+ * @param text Field text.
+ * @param length Field length.
+ * @param decimals Number of fraction digits in the result.
+ * @return The scaled value, 0 for an empty field.
+ */
+uint32_t nmea_parse_fixed(const char *text, uint8_t length, uint8_t decimals);
+
+#endif /* NMEA_H */
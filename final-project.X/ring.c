@@ -0,0 +1,76 @@
+/*
+ * File:   ring.c
+ * Author: chehj
+ *
+ * Created on December 12, 2024, 3:20 PM
+ */
+
+#include <string.h>
+#include "ring.h"
+
+
+/**
+ * @brief Attaches storage to a ring and empties it.
+ *
+ * @param ring Ring state.
+ * @param buffer Storage for the ring.
+ * @param size Size of the storage, must satisfy RING_SIZE_VALID().
+ */
+void ring_init(ring_t *ring, uint8_t *buffer, uint16_t size) {
+    ring->buffer = buffer;
+    ring->mask = (uint8_t)(size - 1);
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+// Append as many bytes as fit, in at most two copies
+uint8_t ring_write(ring_t *ring, const uint8_t *data, uint8_t length) {
+    uint8_t head = ring->head;
+    uint8_t space = ring_space(ring);
+    uint16_t first;
+
+    if (length > space) {
+        length = space;
+    }
+    if (length == 0) {
+        return 0;
+    }
+
+    // Slots up to the end of the storage, then wrap to the start
+    first = (uint16_t)ring->mask + 1 - head;
+    if (first > length) {
+        first = length;
+    }
+    memcpy(&ring->buffer[head], data, first);
+    memcpy(ring->buffer, data + first, length - first);
+
+    RING_BARRIER(); // Data before index
+    ring->head = (head + length) & ring->mask;
+    return length;
+}
+
+// Remove up to length bytes, in at most two copies
+uint8_t ring_read(ring_t *ring, uint8_t *data, uint8_t length) {
+    uint8_t tail = ring->tail;
+    uint8_t count = ring_count(ring);
+    uint16_t first;
+
+    if (length > count) {
+        length = count;
+    }
+    if (length == 0) {
+        return 0;
+    }
+    RING_BARRIER(); // Index before data
+
+    first = (uint16_t)ring->mask + 1 - tail;
+    if (first > length) {
+        first = length;
+    }
+    memcpy(data, &ring->buffer[tail], first);
+    memcpy(data + first, ring->buffer, length - first);
+
+    RING_BARRIER(); // Data before the slots are handed back
+    ring->tail = (tail + length) & ring->mask;
+    return length;
+}
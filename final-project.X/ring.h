@@ -0,0 +1,157 @@
+/*
+ * File:   ring.h
+ * Author: chehj
+ *
+ * Description:
+ * Single-producer/single-consumer byte ring shared by the drivers, and a
+ * one-byte event queue built on it. One side may be an ISR: the producer only
+ * writes head, the consumer only writes tail, and both are single bytes so
+ * every index access is atomic on the AVR. The size must be a power of two
+ * (up to 256) so wrapping is a mask, and one slot is kept free to tell a
+ * full ring from an empty one.
+ *
+ * Created on December 12, 2024, 3:20 PM
+ */
+
+#ifndef RING_H
+#define RING_H
+
+#include <stdint.h>
+
+// Compiler barrier. The AVR does not reorder memory accesses, so keeping the
+// compiler from moving buffer accesses across an index update is all the
+// ordering a single producer and consumer need.
+#define RING_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+// True if size is a valid ring size
+#define RING_SIZE_VALID(size) ((size) >= 2 && (size) <= 256 && ((size) & ((size) - 1)) == 0)
+
+// Ring state, the storage is supplied by the owner
+typedef struct {
+    uint8_t *buffer;        // Storage of mask + 1 bytes
+    uint8_t mask;           // Size - 1
+    volatile uint8_t head;  // Next slot to write, only changed by the producer
+    volatile uint8_t tail;  // Next slot to read, only changed by the consumer
+} ring_t;
+
+// Queue of one-byte event codes, typically posted by an ISR for the main loop
+typedef ring_t event_queue_t;
+
+
+/**
+ * @brief Attaches storage to a ring and empties it.
+ * Call before either side uses the ring.
+ *
+ * @param ring Ring state.
+ * @param buffer Storage for the ring.
+ * @param size Size of the storage, must satisfy RING_SIZE_VALID().
+ */
+void ring_init(ring_t *ring, uint8_t *buffer, uint16_t size);
+
+/**
+ * @brief Number of bytes waiting to be read.
+ * Exact for the consumer, a lower bound for the producer.
+ *
+ * @param ring Ring state.
+ * @return Bytes in the ring.
+ */
+static inline uint8_t ring_count(const ring_t *ring) {
+    return (uint8_t)(ring->head - ring->tail) & ring->mask;
+}
+
+/**
+ * @brief Number of bytes that can be written.
+ * Exact for the producer, a lower bound for the consumer.
+ *
+ * @param ring Ring state.
+ * @return Free bytes in the ring.
+ */
+static inline uint8_t ring_space(const ring_t *ring) {
+    return (uint8_t)(ring->tail - ring->head - 1) & ring->mask;
+}
+
+/**
+ * @brief Appends a byte. Producer side only.
+ *
+ * @param ring Ring state.
+ * @param value Byte to append.
+ * @return 1 if the byte was stored, 0 if the ring is full.
+ */
+static inline uint8_t ring_push(ring_t *ring, uint8_t value) {
+    uint8_t head = ring->head;
+    uint8_t next = (head + 1) & ring->mask;
+
+    if (next == ring->tail) {
+        return 0;
+    }
+    ring->buffer[head] = value;
+    RING_BARRIER(); // Data before index
+    ring->head = next;
+    return 1;
+}
+
+/**
+ * @brief Removes the oldest byte. Consumer side only.
+ *
+ * @param ring Ring state.
+ * @param[out] value Removed byte.
+ * @return 1 if a byte was removed, 0 if the ring is empty.
+ */
+static inline uint8_t ring_pop(ring_t *ring, uint8_t *value) {
+    uint8_t tail = ring->tail;
+
+    if (tail == ring->head) {
+        return 0;
+    }
+    RING_BARRIER(); // Index before data
+    *value = ring->buffer[tail];
+    RING_BARRIER(); // Data before the slot is handed back
+    ring->tail = (tail + 1) & ring->mask;
+    return 1;
+}
+
+/**
+ * @brief Appends as many bytes as fit. Producer side only.
+ * The bytes are copied in at most two blocks and published with a single
+ * index update, so the consumer sees all of them or none.
+ *
+ * @param ring Ring state.
+ * @param data Bytes to append.
+ * @param length Number of bytes to append.
+ * @return Number of bytes stored.
+ */
+uint8_t ring_write(ring_t *ring, const uint8_t *data, uint8_t length);
+
+/**
+ * @brief Removes up to length bytes. Consumer side only.
+ *
+ * @param ring Ring state.
+ * @param[out] data Buffer for the removed bytes.
+ * @param length Size of the buffer.
+ * @return Number of bytes removed.
+ */
+uint8_t ring_read(ring_t *ring, uint8_t *data, uint8_t length);
+
+/**
+ * @brief Posts an event code. Producer side only.
+ *
+ * @param queue Event queue.
+ * @param event Event code.
+ * @return 1 if the event was queued, 0 if the queue is full.
+ */
+static inline uint8_t event_post(event_queue_t *queue, uint8_t event) {
+    return ring_push(queue, event);
+}
+
+/**
+ * @brief Takes the oldest event code. Consumer side only.
+ *
+ * @param queue Event queue.
+ * @param[out] event Event code.
+ * @return 1 if an event was taken, 0 if the queue is empty.
+ */
+static inline uint8_t event_get(event_queue_t *queue, uint8_t *event) {
+    return ring_pop(queue, event);
+}
+
+#endif /* RING_H */
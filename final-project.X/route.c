@@ -0,0 +1,219 @@
+/*
+ * File:   route.c
+ * Author: chehj
+ *
+ * Created on December 10, 2024, 10:05 AM
+ */
+
+#include "route.h"
+
+route_t navRoute;
+
+// Single-waypoint default route: the original destination with the old
+// GPS_THRESHOLD arrival radius. Further waypoints go in the delta table.
+const route_plan_t routeDefault = {
+    449747960, -932334440, GPS_THRESHOLD, 0, 0
+};
+
+
+/**
+ * @brief Projects the active waypoint into the route's local frame.
+ *
+ * @param route Route progress.
+ */
+static void route_load_target(route_t *route) {
+    route->targetProjected = geo_project(&route->origin, route->lat, route->lon, &route->target);
+}
+
+/**
+ * @brief Moves to the next waypoint by applying its delta.
+ *
+ * @param route Route progress, must not be on the last waypoint.
+ */
+static void route_advance(route_t *route) {
+    const route_delta_t *delta = &route->plan->deltas[route->index];
+    
+    route->from = route->target;
+    route->legProjected = route->targetProjected;
+    route->lat += (gps_coord_t)delta->dLat * ROUTE_DELTA_SCALE;
+    route->lon += (gps_coord_t)delta->dLon * ROUTE_DELTA_SCALE;
+    route->radius = delta->radius;
+    route->index++;
+    route_load_target(route);
+}
+
+/**
+ * @brief Measures the position relative to the current leg and updates the
+ * off-route state.
+ *
+ * Cross and dot products of the leg and the offset from its start give the
+ * cross-track and along-track distances. All vectors are scaled down together
+ * until every component is within +/-32767, so the sum of two products fits
+ * in 32 bits; long legs only lose the low bits of the result.
+ *
+ * @param route Route progress with legProjected set.
+ * @param position Position in the local frame.
+ * @return ROUTE_EVENT_OFF_ROUTE or ROUTE_EVENT_ON_ROUTE on a change, else ROUTE_EVENT_NONE.
+ */
+static uint8_t route_corridor(route_t *route, const geo_point_t *position) {
+    int32_t legEast = route->target.east - route->from.east;
+    int32_t legNorth = route->target.north - route->from.north;
+    int32_t offEast = position->east - route->from.east;
+    int32_t offNorth = position->north - route->from.north;
+    geo_point_t zero = { 0, 0 };
+    geo_point_t leg;
+    int32_t length;
+    int32_t along;
+    uint8_t shift = 0;
+    uint8_t event = ROUTE_EVENT_NONE;
+    
+    // -32768 is left out too: two products of -32768 add up to 2^31
+    while (legEast > 32767L || legEast < -32767L || legNorth > 32767L || legNorth < -32767L ||
+           offEast > 32767L || offEast < -32767L || offNorth > 32767L || offNorth < -32767L) {
+        legEast >>= 1;
+        legNorth >>= 1;
+        offEast >>= 1;
+        offNorth >>= 1;
+        shift++;
+    }
+    
+    leg.east = legEast;
+    leg.north = legNorth;
+    length = geo_distance(&zero, &leg);
+    if (length == 0) {
+        return ROUTE_EVENT_NONE; // Repeated waypoint, no direction
+    }
+    
+    // North/east axes: leg x offset is positive when the walker is right of the leg
+    along = (legEast * offEast + legNorth * offNorth) / length;
+    route->crossTrack = ((legNorth * offEast - legEast * offNorth) / length) << shift;
+    route->alongTrack = along << shift;
+    
+    if (!route->offRoute &&
+        (route->crossTrack > ROUTE_CORRIDOR_CM || route->crossTrack < -ROUTE_CORRIDOR_CM)) {
+        route->offRoute = 1;
+        route->offRouteCount++;
+        event = ROUTE_EVENT_OFF_ROUTE;
+    } else if (route->offRoute &&
+               route->crossTrack < ROUTE_CORRIDOR_CM - ROUTE_CORRIDOR_HYSTERESIS_CM &&
+               route->crossTrack > -(ROUTE_CORRIDOR_CM - ROUTE_CORRIDOR_HYSTERESIS_CM)) {
+        route->offRoute = 0;
+        event = ROUTE_EVENT_ON_ROUTE;
+    }
+    
+    // While off route, steer for a point on the leg ahead of the walker
+    // rather than straight at the waypoint
+    if (route->offRoute) {
+        geo_point_t rejoin;
+        
+        along += ROUTE_REJOIN_CM >> shift;
+        if (along < 0) along = 0;
+        if (along > length) along = length;
+        rejoin.east = route->from.east + ((legEast * along / length) << shift);
+        rejoin.north = route->from.north + ((legNorth * along / length) << shift);
+        route->bearing = geo_bearing(position, &rejoin);
+    }
+    return event;
+}
+
+/**
+ * @brief Measures the distance and bearing from a fix to the active waypoint.
+ * Uses the local frame for short legs and the spherical formulas otherwise.
+ *
+ * @param route Route progress.
+ * @param lat Fix latitude (1e-7 degrees).
+ * @param lon Fix longitude (1e-7 degrees).
+ * @param position Fix in the local frame, NULL to project lat/lon.
+ * @return ROUTE_EVENT_OFF_ROUTE or ROUTE_EVENT_ON_ROUTE on a corridor change, else ROUTE_EVENT_NONE.
+ */
+static uint8_t route_measure(route_t *route, gps_coord_t lat, gps_coord_t lon, const geo_point_t *position) {
+    geo_point_t projected;
+    
+    if (position == 0 && geo_project(&route->origin, lat, lon, &projected)) {
+        position = &projected;
+    }
+    
+    if (route->targetProjected && position != 0) {
+        route->distance = geo_distance(position, &route->target);
+        if (route->distance < GEO_PLANE_MAX_CM) {
+            route->bearing = geo_bearing(position, &route->target);
+            return route->legProjected ? route_corridor(route, position) : ROUTE_EVENT_NONE;
+        }
+    }
+    
+    route->distance = (uint32_t)(calc_distance(lat, lon, route->lat, route->lon) * 100.0);
+    route->bearing = calc_bearing(lat, lon, route->lat, route->lon);
+    return ROUTE_EVENT_NONE;
+}
+
+/**
+ * @brief Measures the current leg and advances past reached waypoints.
+ *
+ * @param route Route progress.
+ * @param lat Fix latitude (1e-7 degrees).
+ * @param lon Fix longitude (1e-7 degrees).
+ * @param position Fix in the local frame, NULL to project lat/lon.
+ * @return ROUTE_EVENT_* bits.
+ */
+static uint8_t route_follow(route_t *route, gps_coord_t lat, gps_coord_t lon, const geo_point_t *position) {
+    uint8_t event = ROUTE_EVENT_NONE;
+    
+    if (route->state == ROUTE_IDLE) {
+        return ROUTE_EVENT_NONE;
+    }
+    
+    event = route_measure(route, lat, lon, position);
+    
+    // Closely spaced waypoints can all be passed by one fix
+    while (route->state == ROUTE_ACTIVE && route->distance <= route->radius * 100UL) {
+        if (route->index >= route->plan->legs) {
+            route->state = ROUTE_FINISHED;
+            return event | ROUTE_EVENT_FINISHED;
+        }
+        
+        // Each leg starts inside its corridor
+        if (route->offRoute) {
+            route->offRoute = 0;
+            event |= ROUTE_EVENT_ON_ROUTE;
+        }
+        route_advance(route);
+        event |= route_measure(route, lat, lon, position) | ROUTE_EVENT_WAYPOINT;
+    }
+    
+    return event;
+}
+
+
+// Load a route and make its first waypoint active
+void route_start(route_t *route, const route_plan_t *plan) {
+    route->plan = plan;
+    route->index = 0;
+    route->lat = plan->lat;
+    route->lon = plan->lon;
+    route->radius = plan->radius;
+    route->distance = 0;
+    route->bearing = 0;
+    route->legProjected = 0;
+    route->crossTrack = 0;
+    route->alongTrack = 0;
+    route->offRoute = 0;
+    route->offRouteCount = 0;
+    route->state = ROUTE_ACTIVE;
+    geo_set_origin(&route->origin, plan->lat, plan->lon);
+    route_load_target(route);
+}
+
+// Measure the current leg and advance past reached waypoints
+uint8_t route_update(route_t *route, gps_coord_t lat, gps_coord_t lon) {
+    return route_follow(route, lat, lon, 0);
+}
+
+// Same, from a position already in the route's local frame
+uint8_t route_update_local(route_t *route, gps_coord_t lat, gps_coord_t lon, const geo_point_t *position) {
+    return route_follow(route, lat, lon, position);
+}
+
+// Number of waypoints in the loaded route
+uint16_t route_waypoints(const route_t *route) {
+    return (route->state == ROUTE_IDLE) ? 0 : route->plan->legs + 1;
+}
@@ -0,0 +1,145 @@
+/*
+ * File:   route.h
+ * Author: chehj
+ *
+ * Description:
+ * Multi-waypoint route engine. Routes live in flash as one absolute start
+ * point followed by small deltas, so a route of hundreds of waypoints takes
+ * only a few bytes each. The engine tracks the active waypoint, measures the
+ * current leg on every fix and advances once the walker is inside the
+ * waypoint's arrival radius.
+ *
+ * Created on December 10, 2024, 10:05 AM
+ */
+
+#ifndef ROUTE_H
+#define ROUTE_H
+
+#include <stdint.h>
+#include "geo.h"
+
+// Units of route_delta_t.dLat/dLon in gps_coord_t (1e-6 degrees, ~11 cm)
+#define ROUTE_DELTA_SCALE 10
+
+// Route states
+#define ROUTE_IDLE 0            // No route loaded
+#define ROUTE_ACTIVE 1          // Heading for route.index
+#define ROUTE_FINISHED 2        // Last waypoint reached
+
+// Event bits returned by route_update()
+#define ROUTE_EVENT_NONE 0x00
+#define ROUTE_EVENT_WAYPOINT 0x01   // Reached a waypoint, the next leg is active
+#define ROUTE_EVENT_FINISHED 0x02   // Reached the last waypoint
+#define ROUTE_EVENT_OFF_ROUTE 0x04  // Left the corridor around the current leg
+#define ROUTE_EVENT_ON_ROUTE 0x08   // Back inside the corridor
+
+// Half-width of the corridor around each leg (cm)
+#ifndef ROUTE_CORRIDOR_CM
+#define ROUTE_CORRIDOR_CM 1000
+#endif
+
+// How far back inside the corridor the walker must be to count as on route again (cm)
+#ifndef ROUTE_CORRIDOR_HYSTERESIS_CM
+#define ROUTE_CORRIDOR_HYSTERESIS_CM 300
+#endif
+
+// While off route, steer towards the point this far along the leg from the walker (cm)
+#ifndef ROUTE_REJOIN_CM
+#define ROUTE_REJOIN_CM 1500
+#endif
+
+/**
+ * @brief Offset from the previous waypoint.
+ * 5 bytes per waypoint; each leg can be up to ~3.6 km in either axis.
+ */
+typedef struct {
+    int16_t dLat;               // Latitude change (1e-6 degrees)
+    int16_t dLon;               // Longitude change (1e-6 degrees)
+    uint8_t radius;             // Arrival radius of this waypoint (m)
+} route_delta_t;
+
+/**
+ * @brief Route as stored in flash.
+ * On the ATmega3208 const data stays in flash and is read through the
+ * memory-mapped flash window, so plain const tables need no PROGMEM.
+ */
+typedef struct {
+    gps_coord_t lat;            // First waypoint (1e-7 degrees)
+    gps_coord_t lon;
+    uint8_t radius;             // Arrival radius of the first waypoint (m)
+    uint16_t legs;              // Entries in deltas, one per further waypoint
+    const route_delta_t *deltas;
+} route_plan_t;
+
+// Route progress
+typedef struct {
+    const route_plan_t *plan;
+    geo_origin_t origin;        // Local frame anchored at the first waypoint
+    uint16_t index;             // Active waypoint, 0 is the first
+    gps_coord_t lat;            // Active waypoint (1e-7 degrees)
+    gps_coord_t lon;
+    uint8_t radius;             // Arrival radius of the active waypoint (m)
+    geo_point_t target;         // Active waypoint in the local frame
+    uint8_t targetProjected;    // target is valid
+    geo_point_t from;           // Previous waypoint, start of the current leg
+    uint8_t legProjected;       // from is valid, so the leg has a direction
+    int32_t crossTrack;         // Distance from the leg, positive = right of it (cm)
+    int32_t alongTrack;         // Distance along the leg from its start (cm)
+    uint8_t offRoute;           // Outside the corridor around the leg
+    uint16_t offRouteCount;     // Times the walker left the corridor
+    uint8_t state;              // ROUTE_* value
+    uint32_t distance;          // Distance to go from the last fix (cm)
+    uint16_t bearing;           // Bearing to steer by from the last fix: to the waypoint, or back to the leg while off route (0.01 degrees)
+} route_t;
+
+// Route followed by the navigation code
+extern route_t navRoute;
+
+// Default route, ending at the Platonic Figure by the UMN ME building
+extern const route_plan_t routeDefault;
+
+
+/**
+ * @brief Loads a route and makes its first waypoint active.
+ *
+ * @param route Route progress to reset.
+ * @param plan Route to follow, must stay valid while it is followed.
+ */
+void route_start(route_t *route, const route_plan_t *plan);
+
+/**
+ * @brief Measures the current leg from a new fix and advances past every
+ * waypoint the fix is inside of.
+ * route->index, route->distance and route->bearing describe the leg the
+ * walker is on afterwards. From the second waypoint on, the signed distance
+ * from the leg is checked against the corridor as well.
+ *
+ * @param route Route progress.
+ * @param lat Fix latitude (1e-7 degrees).
+ * @param lon Fix longitude (1e-7 degrees).
+ * @return ROUTE_EVENT_* bits.
+ */
+uint8_t route_update(route_t *route, gps_coord_t lat, gps_coord_t lon);
+
+/**
+ * @brief Like route_update(), for a position already in route->origin's
+ * frame, e.g. the output of the position filter.
+ * lat/lon are only used when the leg is too long for the local frame.
+ *
+ * @param route Route progress.
+ * @param lat Fix latitude (1e-7 degrees).
+ * @param lon Fix longitude (1e-7 degrees).
+ * @param position Position in the local frame.
+ * @return ROUTE_EVENT_* bits.
+ */
+uint8_t route_update_local(route_t *route, gps_coord_t lat, gps_coord_t lon, const geo_point_t *position);
+
+/**
+ * @brief Number of waypoints in the loaded route.
+ *
+ * @param route Route progress.
+ * @return Waypoint count, 0 if no route is loaded.
+ */
+uint16_t route_waypoints(const route_t *route);
+
+#endif /* ROUTE_H */
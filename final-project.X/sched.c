@@ -0,0 +1,90 @@
+/*
+ * File:   sched.c
+ * Author: chehj
+ *
+ * Created on December 12, 2024, 10:40 AM
+ */
+
+#include <avr/io.h>
+#include "sched.h"
+#include "RTC_Operations.h" // For RTC_getMillis() and the deadline helpers
+
+// Below this many ms TCB1 (65536 cycles per wrap) gives the run time exactly
+#define SCHED_CYCLE_RANGE_MS ((uint32_t)65536 * 1000 / F_CPU - 1)
+
+
+/**
+ * @brief Releases every task at the given time and clears the statistics.
+ *
+ * @param tasks Task table.
+ * @param count Number of entries in the table.
+ * @param now Current time in ms.
+ */
+void sched_init(sched_task_t *tasks, uint8_t count, uint32_t now) {
+    for (uint8_t i = 0; i < count; i++) {
+        tasks[i].release = now;
+        tasks[i].runs = 0;
+        tasks[i].misses = 0;
+        tasks[i].lastRuntime = 0;
+        tasks[i].maxRuntime = 0;
+    }
+}
+
+/**
+ * @brief Measures a run in microseconds.
+ * Uses the TCB1 cycle counter for short runs and the millisecond uptime once
+ * the cycle counter may have wrapped.
+ *
+ * @param cycles CPU cycles counted by TCB1, modulo 65536.
+ * @param ms Milliseconds elapsed according to the RTC.
+ * @return Run time in us.
+ */
+static uint32_t sched_runtime(uint16_t cycles, uint32_t ms) {
+    if (ms < SCHED_CYCLE_RANGE_MS) {
+        return (uint32_t)cycles * 1000 / (F_CPU / 1000);
+    }
+    return ms * 1000;
+}
+
+// Runs the most urgent released task
+uint8_t sched_run(sched_task_t *tasks, uint8_t count) {
+    sched_task_t *task = 0;
+    uint32_t now = RTC_getMillis();
+    uint32_t finish;
+    uint16_t startCycles;
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (!RTC_timeReached(now, tasks[i].release)) {
+            continue;
+        }
+        if (task == 0 || tasks[i].priority < task->priority
+                || (tasks[i].priority == task->priority
+                    && (int32_t)(tasks[i].release - task->release) < 0)) {
+            task = &tasks[i];
+        }
+    }
+
+    if (task == 0) {
+        return 0;
+    }
+
+    startCycles = TCB1.CNT;
+    task->run();
+    finish = RTC_getMillis();
+
+    task->lastRuntime = sched_runtime(TCB1.CNT - startCycles, finish - now);
+    if (task->lastRuntime > task->maxRuntime) {
+        task->maxRuntime = task->lastRuntime;
+    }
+    task->runs++;
+
+    if (!RTC_timeReached(task->release + task->deadline, finish)) {
+        task->misses++;
+    }
+
+    task->release += task->period;
+    if (RTC_timeReached(finish, task->release + task->period)) {
+        task->release = finish; // A whole period behind, drop the missed releases
+    }
+    return 1;
+}
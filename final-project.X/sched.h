@@ -0,0 +1,68 @@
+/*
+ * File:   sched.h
+ * Author: chehj
+ *
+ * Description:
+ * Static cooperative scheduler for the main loop. Each task has a release
+ * period, a deadline relative to its release and a priority. Tasks run to
+ * completion, so a task's worst-case start delay is bounded by the longest
+ * run time of any other task; misses and run times are recorded per task so
+ * that bound can be checked on the device.
+ *
+ * Created on December 12, 2024, 10:40 AM
+ */
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdint.h>
+
+#ifndef F_CPU
+#define F_CPU 3333333
+#endif
+
+// Task entry point
+typedef void (*sched_fn_t)(void);
+
+// Task table entry
+typedef struct {
+    const char *name;       // Short name for telemetry
+    sched_fn_t run;         // Entry point, must not block
+    uint16_t period;        // Release interval (ms)
+    uint16_t deadline;      // Must have finished this long after its release (ms)
+    uint8_t priority;       // Lower value runs first when several tasks are released
+    uint32_t release;       // Next release time (ms)
+    uint16_t runs;          // Completed runs, wraps
+    uint16_t misses;        // Runs that finished after their deadline
+    uint32_t lastRuntime;   // Run time of the last run (us)
+    uint32_t maxRuntime;    // Longest run time seen (us)
+} sched_task_t;
+
+// Task table entry with everything but the statistics filled in
+#define SCHED_TASK(name, run, period, deadline, priority) \
+    { (name), (run), (period), (deadline), (priority), 0, 0, 0, 0, 0 }
+
+
+/**
+ * @brief Releases every task at the given time and clears the statistics.
+ *
+ * @param tasks Task table.
+ * @param count Number of entries in the table.
+ * @param now Current time in ms.
+ */
+void sched_init(sched_task_t *tasks, uint8_t count, uint32_t now);
+
+/**
+ * @brief Runs the highest-priority released task, if any.
+ * Ties are broken by the earliest release, then by table order. The task's
+ * next release is one period after its last one, or the finish time if it
+ * has fallen a whole period behind, so an overrun never causes a burst of
+ * back-to-back runs.
+ *
+ * @param tasks Task table.
+ * @param count Number of entries in the table.
+ * @return 1 if a task ran, 0 if none was released.
+ */
+uint8_t sched_run(sched_task_t *tasks, uint8_t count);
+
+#endif /* SCHED_H */
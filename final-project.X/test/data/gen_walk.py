@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+#
+# Generates walk.nmea, the synthetic NMEA corpus used by the host tests.
+#
+# A walker stands still for two minutes, walks north-east at 1.2 m/s for
+# four minutes and stands still again for one minute. The receiver reports
+# GGA, RMC, VTG, GSA and three GSV sentences once a second. Position error is
+# a first-order Gauss-Markov process (60 s correlation time) with a standard
+# deviation of 3 m per unit of HDOP, which varies between 0.7 and 1.8. About
+# 1% of the sentences have one character corrupted after the checksum was
+# computed, as a bit error on the link would.
+#
+# The output is deterministic; rerun with "python3 gen_walk.py > walk.nmea".
+#
+
+import math
+import random
+
+random.seed(2024)
+
+ORIGIN_LAT = 43.0747       # Degrees
+ORIGIN_LON = -89.3842
+M_PER_DEG_LAT = 111194.93
+M_PER_DEG_LON = M_PER_DEG_LAT * math.cos(math.radians(ORIGIN_LAT))
+
+STAND1 = 120               # Seconds standing, walking, standing
+WALK = 240
+STAND2 = 60
+SPEED = 1.2                # m/s
+HEADING = 45.0             # Degrees from north
+
+SIGMA_PER_HDOP = 3.0       # m
+TAU = 60.0                 # s
+CORRUPT_RATE = 0.01
+
+
+def checksum(body):
+    value = 0
+    for c in body:
+        value ^= ord(c)
+    return value
+
+
+def sentence(body):
+    text = "$%s*%02X" % (body, checksum(body))
+    if random.random() < CORRUPT_RATE:
+        i = random.randrange(1, len(text) - 3)
+        c = text[i]
+        text = text[:i] + chr(ord(c) ^ 0x01) + text[i + 1:]
+    return text + "\r\n"
+
+
+def nmea_lat(lat):
+    hemi = "N" if lat >= 0 else "S"
+    lat = abs(lat)
+    deg = int(lat)
+    return "%02d%08.5f" % (deg, (lat - deg) * 60), hemi
+
+
+def nmea_lon(lon):
+    hemi = "E" if lon >= 0 else "W"
+    lon = abs(lon)
+    deg = int(lon)
+    return "%03d%08.5f" % (deg, (lon - deg) * 60), hemi
+
+
+def main():
+    out = []
+    east = north = 0.0
+    err_e = err_n = 0.0
+    hdop = 1.0
+    a = math.exp(-1.0 / TAU)
+
+    for t in range(STAND1 + WALK + STAND2):
+        walking = STAND1 <= t < STAND1 + WALK
+        if walking:
+            east += SPEED * math.sin(math.radians(HEADING))
+            north += SPEED * math.cos(math.radians(HEADING))
+
+        hdop = min(1.8, max(0.7, hdop + random.gauss(0, 0.05)))
+        sigma = SIGMA_PER_HDOP * hdop
+        err_e = a * err_e + math.sqrt(1 - a * a) * random.gauss(0, sigma)
+        err_n = a * err_n + math.sqrt(1 - a * a) * random.gauss(0, sigma)
+
+        lat = ORIGIN_LAT + (north + err_n) / M_PER_DEG_LAT
+        lon = ORIGIN_LON + (east + err_e) / M_PER_DEG_LON
+        lat_s, lat_h = nmea_lat(lat)
+        lon_s, lon_h = nmea_lon(lon)
+
+        secs = 15 * 3600 + 20 * 60 + t
+        hhmmss = "%02d%02d%02d.00" % (secs // 3600, secs // 60 % 60, secs % 60)
+        sats = 9 if hdop < 1.2 else 7
+        knots = SPEED / 0.514444 if walking else random.uniform(0, 0.15)
+        course = HEADING + random.gauss(0, 3) if walking else random.uniform(0, 360)
+
+        out.append(sentence("GNGGA,%s,%s,%s,%s,%s,1,%02d,%.2f,265.3,M,-33.9,M,," %
+                            (hhmmss, lat_s, lat_h, lon_s, lon_h, sats, hdop)))
+        out.append(sentence("GNRMC,%s,A,%s,%s,%s,%s,%.3f,%.2f,141224,,,A" %
+                            (hhmmss, lat_s, lat_h, lon_s, lon_h, knots, course)))
+        out.append(sentence("GNVTG,%.2f,T,,M,%.3f,N,%.3f,K,A" % (course, knots, knots * 1.852)))
+        out.append(sentence("GNGSA,A,3,02,05,12,13,15,18,20,25,29,,,,%.2f,%.2f,%.2f" %
+                            (hdop * 1.6, hdop, hdop * 1.3)))
+        for i in range(3):
+            out.append(sentence("GPGSV,3,%d,11,%02d,%02d,%03d,%02d,%02d,%02d,%03d,%02d,"
+                                "%02d,%02d,%03d,%02d,%02d,%02d,%03d,%02d" %
+                                ((i + 1,) + tuple(random.randrange(1, 90) for _ in range(16)))))
+
+    print("".join(out), end="")
+
+
+if __name__ == "__main__":
+    main()
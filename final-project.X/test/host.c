@@ -0,0 +1,78 @@
+/*
+ * File:   host.c
+ * Author: chehj
+ *
+ * Created on December 14, 2024, 3:00 PM
+ */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+#include "host.h"
+#include "gps.h"
+#include "printf.h"
+
+TCB_t TCB1;
+volatile uint8_t SREG;
+
+volatile uint8_t statesActive = 0;
+volatile bool gps_data_ready = false;
+
+uint32_t hostMillis = 0;
+uint32_t hostPrintedBytes = 0;
+
+// The test controls the time
+uint32_t RTC_getMillis(void) {
+    return hostMillis;
+}
+
+// A bus that never answers: transactions stay queued until TWI_abort()
+static twi_transaction_t *hostTwiQueued = 0;
+
+void TWI_init(void) {
+    hostTwiQueued = 0;
+}
+
+uint8_t TWI_submit(twi_transaction_t *t) {
+    if (hostTwiQueued) {
+        return 0;
+    }
+    t->status = TWI_STATUS_PENDING;
+    hostTwiQueued = t;
+    return 1;
+}
+
+uint8_t TWI_wait(twi_transaction_t *t) {
+    TWI_abort();
+    return t->status == TWI_STATUS_DONE;
+}
+
+void TWI_abort(void) {
+    twi_transaction_t *t = hostTwiQueued;
+
+    hostTwiQueued = 0;
+    if (t) {
+        t->status = TWI_STATUS_ERROR;
+        if (t->callback) {
+            t->callback(t);
+        }
+    }
+}
+
+// Debug output is counted, not printed
+void USART2_INIT(void) {
+}
+
+void USART2_PRINTF(char *str) {
+    hostPrintedBytes += strlen(str);
+}
+
+void USART2_PRINTF_MOD(const char *format, ...) {
+    char buffer[128];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    hostPrintedBytes += strlen(buffer);
+}
@@ -0,0 +1,23 @@
+/*
+ * File:   host.h
+ * Author: chehj
+ *
+ * Description:
+ * Stand-ins for the hardware drivers and main.c globals, so modules such as
+ * gps.c can be linked into the host tests.
+ *
+ * Created on December 14, 2024, 3:00 PM
+ */
+
+#ifndef HOST_H
+#define HOST_H
+
+#include <stdint.h>
+
+// Value returned by RTC_getMillis(), set by the test
+extern uint32_t hostMillis;
+
+// Bytes passed to the USART2 print functions
+extern uint32_t hostPrintedBytes;
+
+#endif /* HOST_H */
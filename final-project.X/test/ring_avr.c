@@ -0,0 +1,24 @@
+/*
+ * File:   ring_avr.c
+ * Author: chehj
+ *
+ * Description:
+ * Built for the ATmega3208 by "make avr-disasm" only. Wraps the inline ring
+ * operations in functions on a global ring, the way the USART1 receive ISR
+ * uses them, so their code can be counted in the disassembly.
+ *
+ * Created on December 15, 2024, 9:00 AM
+ */
+
+#include "ring.h"
+
+static uint8_t storage[64];
+ring_t avrRing = { storage, sizeof(storage) - 1, 0, 0 };
+
+uint8_t avr_ring_push(uint8_t value) {
+    return ring_push(&avrRing, value);
+}
+
+uint8_t avr_ring_pop(uint8_t *value) {
+    return ring_pop(&avrRing, value);
+}
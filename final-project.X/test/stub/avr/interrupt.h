@@ -0,0 +1,19 @@
+/*
+ * File:   interrupt.h
+ * Author: chehj
+ *
+ * Description:
+ * Host stand-in for <avr/interrupt.h>. The host tests have no interrupts, so
+ * masking them does nothing.
+ *
+ * Created on December 14, 2024, 10:00 AM
+ */
+
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+#define cli()
+#define sei()
+#define ISR(vector) void vector(void)
+
+#endif /* HOST_AVR_INTERRUPT_H */
@@ -0,0 +1,27 @@
+/*
+ * File:   io.h
+ * Author: chehj
+ *
+ * Description:
+ * Host stand-in for <avr/io.h>. Only declares the registers that the
+ * hardware-independent modules touch; the host tests define them in host.c.
+ *
+ * Created on December 14, 2024, 10:00 AM
+ */
+
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+#include <stdint.h>
+
+// TCB used as a free-running cycle counter for profiling
+typedef struct {
+    volatile uint16_t CNT;
+} TCB_t;
+
+extern TCB_t TCB1;
+extern volatile uint8_t SREG;
+
+#define CPU_I_bm 0x80
+
+#endif /* HOST_AVR_IO_H */
@@ -0,0 +1,17 @@
+/*
+ * File:   delay.h
+ * Author: chehj
+ *
+ * Description:
+ * Host stand-in for <util/delay.h>.
+ *
+ * Created on December 14, 2024, 10:00 AM
+ */
+
+#ifndef HOST_UTIL_DELAY_H
+#define HOST_UTIL_DELAY_H
+
+#define _delay_ms(ms)
+#define _delay_us(us)
+
+#endif /* HOST_UTIL_DELAY_H */
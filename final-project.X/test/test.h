@@ -0,0 +1,44 @@
+/*
+ * File:   test.h
+ * Author: chehj
+ *
+ * Description:
+ * Minimal helpers shared by the host tests: a check macro that counts
+ * failures and a monotonic clock for the benchmarks.
+ *
+ * Created on December 14, 2024, 10:00 AM
+ */
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+#include <time.h>
+
+static int testFailures = 0;
+
+// Report a failed condition and keep going
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            testFailures++; \
+        } \
+    } while (0)
+
+// Print the outcome and return the exit code for main()
+#define TEST_DONE(name) \
+    (printf("%s: %s\n", (name), testFailures ? "FAILED" : "passed"), testFailures != 0)
+
+/**
+ * @brief Reads the host's monotonic clock.
+ *
+ * @return Time in ns.
+ */
+static inline double test_nanoseconds(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+#endif /* TEST_H */
@@ -0,0 +1,121 @@
+/*
+ * File:   test_coord.c
+ * Author: chehj
+ *
+ * Description:
+ * Host test of convert_to_decimal() against a double-precision reference,
+ * with the 32-bit float conversion it replaced shown for comparison.
+ *
+ * Created on December 14, 2024, 3:00 PM
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "gps.h"
+
+// Random coordinates checked
+#define SAMPLES 200000
+
+// Metres per 1e-7 degree of latitude
+#define M_PER_UNIT 0.0111194927
+
+static uint32_t seed = 777;
+
+/**
+ * @brief Deterministic pseudo-random numbers.
+ *
+ * @return Value in 0 - 2^24 - 1.
+ */
+static uint32_t test_random(void) {
+    seed = seed * 1103515245UL + 12345;
+    return seed >> 8;
+}
+
+/**
+ * @brief The conversion before the integer rewrite, with avr-gcc's 32-bit double.
+ */
+static float float_convert(const char *coord) {
+    float raw = (float)atof(coord);
+    int degrees = (int)(raw / 100);
+    float minutes = raw - (degrees * 100);
+
+    return degrees + (minutes / 60.0f);
+}
+
+/**
+ * @brief Converts one NMEA field and compares it with the reference.
+ *
+ * @param text ddmm.mmmmm or dddmm.mmmmm field.
+ * @param[in,out] worst Largest error of the integer conversion (1e-7 degrees).
+ * @param[in,out] worstFloat Largest error of the float conversion (1e-7 degrees).
+ */
+static void check_field(const char *text, double *worst, double *worstFloat) {
+    double raw = strtod(text, 0);
+    double degrees = floor(raw / 100);
+    double reference = (degrees + (raw - degrees * 100) / 60.0) * GPS_COORD_SCALE;
+    double error = fabs(convert_to_decimal(text, 'N') - reference);
+    double errorFloat = fabs(float_convert(text) * (double)GPS_COORD_SCALE - reference);
+
+    if (error > *worst) {
+        *worst = error;
+    }
+    if (errorFloat > *worstFloat) {
+        *worstFloat = errorFloat;
+    }
+    CHECK(convert_to_decimal(text, 'S') == -convert_to_decimal(text, 'N'));
+}
+
+// Random latitudes and longitudes with 4 and 5 decimals of minutes
+static void test_random_fields(void) {
+    double worst = 0;
+    double worstFloat = 0;
+    char text[16];
+
+    for (uint32_t i = 0; i < SAMPLES; i++) {
+        uint32_t degrees = test_random() % ((i & 1) ? 180 : 90);
+        uint32_t minutes = test_random() % 6000000UL;
+
+        if (i & 2) {
+            snprintf(text, sizeof(text), (i & 1) ? "%03lu%02lu.%05lu" : "%02lu%02lu.%05lu",
+                     (unsigned long)degrees, (unsigned long)(minutes / 100000), (unsigned long)(minutes % 100000));
+        } else {
+            snprintf(text, sizeof(text), (i & 1) ? "%03lu%02lu.%04lu" : "%02lu%02lu.%04lu",
+                     (unsigned long)degrees, (unsigned long)(minutes / 100000), (unsigned long)(minutes % 100000 / 10));
+        }
+        check_field(text, &worst, &worstFloat);
+    }
+
+    printf("convert_to_decimal: worst error %.3f units of 1e-7 degrees (%.2f mm)\n",
+           worst, worst * M_PER_UNIT * 1000);
+    printf("old float conversion: worst error %.0f units of 1e-7 degrees (%.2f m)\n",
+           worstFloat, worstFloat * M_PER_UNIT);
+    CHECK(worst <= 0.5 + 1e-6);
+}
+
+// Edges of the field format
+static void test_edges(void) {
+    CHECK(convert_to_decimal("0000.00000", 'N') == 0);
+    CHECK(convert_to_decimal("", 'N') == 0);
+    CHECK(convert_to_decimal("4807.038", 'N') == 481173000L);
+    CHECK(convert_to_decimal("01131.000", 'E') == 115166667L);
+    CHECK(convert_to_decimal("01131.000", 'W') == -115166667L);
+    CHECK(convert_to_decimal("8959.99999", 'N') == 899999998L);
+    CHECK(convert_to_decimal("17959.99999", 'E') == 1799999998L);
+}
+
+// Formatting gives back the same value
+static void test_format(void) {
+    CHECK(strcmp(format_coord(481173000L), "48.1173000") == 0);
+    CHECK(strcmp(format_coord(-115166667L), "-11.5166667") == 0);
+    CHECK(strcmp(format_coord(-5L), "-0.0000005") == 0);
+}
+
+int main(void) {
+    test_edges();
+    test_format();
+    test_random_fields();
+    return TEST_DONE("test_coord");
+}
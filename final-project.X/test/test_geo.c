@@ -0,0 +1,171 @@
+/*
+ * File:   test_geo.c
+ * Author: chehj
+ *
+ * Description:
+ * Accuracy report of the tangent-plane geometry in geo.c against the
+ * haversine distance and great-circle bearing of calc_distance() and
+ * calc_bearing() in gps.c. Legs are swept in distance and bearing out to
+ * GEO_PLANE_MAX_CM from start points up to 1 km from the frame origin, at
+ * several latitudes.
+ *
+ * Created on December 16, 2024, 2:00 PM
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include "test.h"
+#include "gps.h"
+#include "geo.h"
+
+// Bearings per leg length (every 5 degrees)
+#define BEARING_STEPS 72
+
+// Leg lengths per start point, spread geometrically from 1 m to GEO_PLANE_MAX_CM
+#define DISTANCE_STEPS 40
+
+// Start points per latitude
+#define START_POINTS 8
+
+// Legs shorter than this are left out of the bearing and relative errors,
+// where the 1.1 cm steps of the coordinates dominate (cm)
+#define ERROR_MIN_CM 1000
+
+// Allowed error: 0.2% of the leg plus 2 cm of rounding, and 0.2 degrees
+#define DISTANCE_TOLERANCE 0.002
+#define BEARING_TOLERANCE 20
+
+static uint32_t seed = 4242;
+
+/**
+ * @brief Deterministic pseudo-random numbers.
+ *
+ * @return Value in 0 - 2^24 - 1.
+ */
+static uint32_t test_random(void) {
+    seed = seed * 1103515245UL + 12345;
+    return seed >> 8;
+}
+
+/**
+ * @brief Great-circle destination on the haversine sphere.
+ *
+ * @param lat Start latitude (1e-7 degrees).
+ * @param lon Start longitude (1e-7 degrees).
+ * @param distance Leg length (m).
+ * @param bearing Initial bearing (degrees).
+ * @param[out] lat2 End latitude (1e-7 degrees).
+ * @param[out] lon2 End longitude (1e-7 degrees).
+ */
+static void destination(gps_coord_t lat, gps_coord_t lon, double distance, double bearing,
+                        gps_coord_t *lat2, gps_coord_t *lon2) {
+    double phi = degrees_to_radians(lat / (double)GPS_COORD_SCALE);
+    double delta = distance / EARTH_RADIUS;
+    double theta = degrees_to_radians(bearing);
+    double phi2 = asin(sin(phi) * cos(delta) + cos(phi) * sin(delta) * cos(theta));
+    double dlon = atan2(sin(theta) * sin(delta) * cos(phi), cos(delta) - sin(phi) * sin(phi2));
+
+    *lat2 = (gps_coord_t)lround(phi2 * 180.0 / M_PI * GPS_COORD_SCALE);
+    *lon2 = lon + (gps_coord_t)lround(dlon * 180.0 / M_PI * GPS_COORD_SCALE);
+}
+
+/**
+ * @brief Sweeps legs around one origin latitude and prints the worst errors.
+ *
+ * @param latDegrees Origin latitude (degrees).
+ */
+static void sweep(double latDegrees) {
+    gps_coord_t originLat = (gps_coord_t)lround(latDegrees * GPS_COORD_SCALE);
+    gps_coord_t originLon = -893842000L;
+    geo_origin_t origin;
+    double worstDistance = 0;       // cm
+    double worstRelative = 0;       // Fraction of the leg
+    double worstBearing = 0;        // 0.01 degrees
+    uint32_t legs = 0;
+
+    geo_set_origin(&origin, originLat, originLon);
+    for (int s = 0; s < START_POINTS; s++) {
+        gps_coord_t lat;
+        gps_coord_t lon;
+
+        // First start point at the origin, the others up to 1 km away
+        destination(originLat, originLon, s ? (test_random() % 1000) : 0, test_random() % 360, &lat, &lon);
+
+        for (int d = 0; d < DISTANCE_STEPS; d++) {
+            double meters = exp(log(GEO_PLANE_MAX_CM / 100.0) * d / (DISTANCE_STEPS - 1));
+
+            for (int b = 0; b < BEARING_STEPS; b++) {
+                geo_point_t from;
+                geo_point_t to;
+                gps_coord_t lat2;
+                gps_coord_t lon2;
+                double reference;
+                double error;
+
+                destination(lat, lon, meters, b * 360.0 / BEARING_STEPS, &lat2, &lon2);
+                CHECK(geo_project(&origin, lat, lon, &from) && geo_project(&origin, lat2, lon2, &to));
+
+                reference = calc_distance(lat, lon, lat2, lon2) * 100;
+                error = fabs(geo_distance(&from, &to) - reference);
+                if (error > worstDistance) {
+                    worstDistance = error;
+                }
+                if (reference >= ERROR_MIN_CM && error / reference > worstRelative) {
+                    worstRelative = error / reference;
+                }
+                CHECK(error <= reference * DISTANCE_TOLERANCE + 2);
+
+                if (reference >= ERROR_MIN_CM) {
+                    error = fabs((double)geo_bearing(&from, &to) - calc_bearing(lat, lon, lat2, lon2));
+                    if (error > 18000) {
+                        error = 36000 - error;
+                    }
+                    if (error > worstBearing) {
+                        worstBearing = error;
+                    }
+                    CHECK(error <= BEARING_TOLERANCE);
+                }
+                legs++;
+            }
+        }
+    }
+
+    printf("latitude %4.1f: %lu legs to %ld m, worst distance error %.1f cm (%.3f%%), worst bearing error %.2f deg\n",
+           latDegrees, (unsigned long)legs, GEO_PLANE_MAX_CM / 100, worstDistance, worstRelative * 100,
+           worstBearing / 100);
+}
+
+// Building blocks against libm
+static void test_math(void) {
+    uint32_t worst = 0;
+
+    CHECK(geo_sqrt(0) == 0 && geo_sqrt(1) == 1 && geo_sqrt(0xFFFFFFFFUL) == 65535);
+    for (uint32_t i = 0; i < 100000; i++) {
+        uint32_t value = test_random() * 256 + (i & 0xFF);
+        uint16_t root = geo_sqrt(value);
+
+        CHECK((uint64_t)root * root <= value && ((uint64_t)root + 1) * (root + 1) > value);
+    }
+    for (int a = 0; a < 36000; a += 7) {
+        double radians = a * M_PI / 18000;
+        uint32_t angle = geo_atan2((int32_t)lround(sin(radians) * 100000), (int32_t)lround(cos(radians) * 100000));
+        uint32_t error = (angle > (uint32_t)a) ? angle - a : a - angle;
+
+        if (error > 18000) {
+            error = 36000 - error;
+        }
+        if (error > worst) {
+            worst = error;
+        }
+    }
+    printf("geo_atan2: worst error %.2f deg\n", worst / 100.0);
+    CHECK(worst <= 5);
+}
+
+int main(void) {
+    test_math();
+    sweep(0.0);
+    sweep(43.0747);
+    sweep(60.0);
+    return TEST_DONE("test_geo");
+}
@@ -0,0 +1,138 @@
+/*
+ * File:   test_gps.c
+ * Author: chehj
+ *
+ * Description:
+ * Host tests of gps.c: speed, course and position from RMC and VTG only
+ * reach gpsFix once the GGA of the same epoch has passed the quality gate,
+ * whichever order the receiver sends them in, and a burst on a bus that
+ * never answers times out instead of stopping intake.
+ *
+ * Created on December 16, 2024, 10:00 AM
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "test.h"
+#include "host.h"
+#include "gps.h"
+
+// Fix quality fields of a GGA that passes and of one that fails the gate
+#define GGA_GOOD "1,08,0.90"
+#define GGA_BAD "0,00,99.99"
+
+/**
+ * @brief Adds the checksum to a sentence body and feeds it to gps.c.
+ *
+ * @param body Sentence without the '$' and the checksum.
+ */
+static void feed(const char *body) {
+    char sentence[128];
+    uint8_t sum = 0;
+
+    for (const char *p = body; *p; p++) {
+        sum ^= (uint8_t)*p;
+    }
+    snprintf(sentence, sizeof(sentence), "$%s*%02X\r\n", body, sum);
+    for (const char *p = sentence; *p; p++) {
+        nmea_feed(&gpsLexer, *p);
+    }
+}
+
+static void feed_gga(const char *time, const char *lat, const char *quality) {
+    char body[96];
+
+    snprintf(body, sizeof(body), "GNGGA,%s,%s,N,08923.05200,W,%s,265.3,M,-33.9,M,,", time, lat, quality);
+    feed(body);
+}
+
+static void feed_rmc(const char *time, const char *lat) {
+    char body[96];
+
+    snprintf(body, sizeof(body), "GNRMC,%s,A,%s,N,08923.05200,W,2.500,45.00,161224,,,A", time, lat);
+    feed(body);
+}
+
+// RMC and VTG before their GGA: held, then dropped or committed by the gate
+static void test_motion_first(void) {
+    GPS_init();
+
+    feed_rmc("152000.00", "4304.48200");
+    feed("GNVTG,45.00,T,,M,2.500,N,4.630,K,A");
+    CHECK(!(gpsFix.valid & (GPS_VALID_POSITION | GPS_VALID_MOTION)));
+    feed_gga("152000.00", "4304.48200", GGA_BAD);
+    CHECK(!(gpsFix.valid & (GPS_VALID_POSITION | GPS_VALID_MOTION)));
+    CHECK(gpsFix.latitude == 0 && gpsFix.speed == 0);
+
+    feed_rmc("152001.00", "4304.48300");
+    CHECK(!(gpsFix.valid & GPS_VALID_MOTION));
+    feed_gga("152001.00", "4304.48300", GGA_GOOD);
+    CHECK((gpsFix.valid & GPS_VALID_POSITION) && (gpsFix.valid & GPS_VALID_MOTION) == GPS_VALID_MOTION);
+    CHECK(gpsFix.course == 4500 && gpsFix.speed == 128);
+    CHECK(gpsFix.latitude == convert_to_decimal("4304.48300", 'N'));
+}
+
+// GGA before its RMC and VTG: motion follows the GGA's result
+static void test_gga_first(void) {
+    GPS_init();
+
+    feed_gga("152000.00", "4304.48200", GGA_GOOD);
+    feed_rmc("152000.00", "4304.48200");
+    CHECK((gpsFix.valid & GPS_VALID_MOTION) == GPS_VALID_MOTION);
+
+    // A rejected epoch invalidates the motion and keeps the last good position
+    feed_gga("152001.00", "4304.99900", GGA_BAD);
+    feed_rmc("152001.00", "4304.99900");
+    feed("GNVTG,90.00,T,,M,2.500,N,4.630,K,A");
+    CHECK(!(gpsFix.valid & (GPS_VALID_POSITION | GPS_VALID_MOTION)));
+    CHECK(gpsFix.latitude == convert_to_decimal("4304.48200", 'N'));
+    CHECK(gpsFix.course == 4500);
+
+    // The next good GGA does not pick up the rejected epoch's motion
+    feed_gga("152002.00", "4304.48400", GGA_GOOD);
+    CHECK(gpsFix.valid & GPS_VALID_POSITION);
+    CHECK(!(gpsFix.valid & GPS_VALID_MOTION));
+    CHECK(gpsRejected.noFix == 1);
+}
+
+// An RMC warning status drops what was held
+static void test_warning(void) {
+    GPS_init();
+
+    feed_rmc("152000.00", "4304.48200");
+    feed("GNRMC,152000.00,V,,,,,,,161224,,,N");
+    feed_gga("152000.00", "4304.48200", GGA_GOOD);
+    CHECK(gpsFix.valid & GPS_VALID_POSITION);
+    CHECK(!(gpsFix.valid & GPS_VALID_MOTION));
+}
+
+// A read that never completes is aborted and polling carries on
+static void test_burst_timeout(void) {
+    GPS_init();
+    hostMillis = 1000;
+
+    gps_service(); // Starts a burst that hangs
+    hostMillis += GPS_BURST_TIMEOUT_MS - 1;
+    gps_service();
+    CHECK(gpsBurstTimeouts == 0);
+
+    hostMillis += 1;
+    gps_service();
+    CHECK(gpsBurstTimeouts == 1);
+    CHECK(gpsPollInterval == GPS_POLL_BASE_MS * 2); // Empty burst backs off
+
+    // The next poll starts a fresh burst, which times out in turn
+    hostMillis += gpsPollInterval;
+    gps_service();
+    hostMillis += GPS_BURST_TIMEOUT_MS;
+    gps_service();
+    CHECK(gpsBurstTimeouts == 2);
+}
+
+int main(void) {
+    test_motion_first();
+    test_gga_first();
+    test_warning();
+    test_burst_timeout();
+    return TEST_DONE("test_gps");
+}
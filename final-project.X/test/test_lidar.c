@@ -0,0 +1,162 @@
+/*
+ * File:   test_lidar.c
+ * Author: chehj
+ *
+ * Description:
+ * Host test of the TFMini frame parser in lidar.c. Every byte fed in must
+ * end up in a decoded frame, in framingErrors or still buffered, including
+ * on streams with dropped, corrupted and stray bytes.
+ *
+ * Created on December 16, 2024, 4:00 PM
+ */
+
+#include <stdint.h>
+#include "test.h"
+#include "lidar.h"
+
+// Frames in the noisy stream
+#define STREAM_FRAMES 20000
+
+static uint32_t seed = 99;
+
+// lidar.c reads the sensor through the USART driver; none of it is used here
+char usartReadChar(void) {
+    return 0;
+}
+
+uint8_t usartTryReadChar(uint8_t *c) {
+    (void)c;
+    return 0;
+}
+
+void usartWriteChar(uint8_t c) {
+    (void)c;
+}
+
+uint32_t RTC_getMillis(void) {
+    return 0;
+}
+
+/**
+ * @brief Deterministic pseudo-random numbers.
+ *
+ * @return Value in 0 - 2^24 - 1.
+ */
+static uint32_t test_random(void) {
+    seed = seed * 1103515245UL + 12345;
+    return seed >> 8;
+}
+
+/**
+ * @brief Builds a valid data frame.
+ *
+ * @param[out] frame BUF_SIZE bytes.
+ * @param distance Distance field (cm).
+ */
+static void make_frame(uint8_t *frame, uint16_t distance) {
+    frame[0] = HEADER;
+    frame[1] = HEADER;
+    frame[2] = distance & 0xFF;
+    frame[3] = distance >> 8;
+    frame[4] = 0x20;
+    frame[5] = 0x03;
+    frame[6] = 0x00;
+    frame[7] = 0x09;
+    frame[8] = 0;
+    for (uint8_t i = 0; i < BUF_SIZE - 1; i++) {
+        frame[8] += frame[i];
+    }
+}
+
+/**
+ * @brief Checks that no byte went missing from the accounting.
+ *
+ * @param parser Parser state.
+ * @param fed Bytes fed so far.
+ */
+static uint8_t accounted(const lidar_parser_t *parser, uint32_t fed) {
+    return (uint32_t)parser->frames * BUF_SIZE + parser->framingErrors + parser->count == fed;
+}
+
+// Hand-made cases around the header search
+static void test_cases(void) {
+    static const uint8_t loneHeader[] = { HEADER, 0x10 };
+    static const uint8_t shifted[] = { HEADER, HEADER, HEADER };
+    lidar_parser_t parser;
+    lidar_frame_t frame;
+    uint8_t bytes[BUF_SIZE];
+    uint32_t fed = 0;
+
+    lidar_parser_init(&parser);
+
+    // A lone header byte followed by anything else drops both
+    for (uint8_t i = 0; i < sizeof(loneHeader); i++) {
+        CHECK(!lidar_parse_byte(&parser, loneHeader[i], &frame));
+        fed++;
+    }
+    CHECK(parser.framingErrors == 2 && parser.count == 0);
+
+    // An extra header before a frame: the checksum fails one byte early, the
+    // resync drops the extra header and the frame completes with its last byte
+    for (uint8_t i = 0; i < sizeof(shifted); i++) {
+        CHECK(!lidar_parse_byte(&parser, shifted[i], &frame));
+        fed++;
+    }
+    make_frame(bytes, 123);
+    for (uint8_t i = 2; i < BUF_SIZE - 1; i++) {
+        CHECK(!lidar_parse_byte(&parser, bytes[i], &frame));
+        fed++;
+    }
+    CHECK(lidar_parse_byte(&parser, bytes[BUF_SIZE - 1], &frame) && frame.distance == 123);
+    fed++;
+    CHECK(parser.checksumErrors == 1 && parser.framingErrors == 3);
+    CHECK(accounted(&parser, fed));
+}
+
+// Random damage to a stream of valid frames
+static void test_stream(void) {
+    lidar_parser_t parser;
+    lidar_frame_t frame;
+    uint8_t bytes[BUF_SIZE];
+    uint32_t fed = 0;
+    uint32_t decoded = 0;
+    uint32_t intact = 0;
+
+    lidar_parser_init(&parser);
+    for (uint32_t n = 0; n < STREAM_FRAMES; n++) {
+        uint32_t damage = test_random() % 100;
+        uint8_t skip = BUF_SIZE;
+
+        make_frame(bytes, (uint16_t)(n % 1200));
+        if (damage < 5) {
+            bytes[test_random() % BUF_SIZE] ^= 1 << (test_random() % 8);
+        } else if (damage < 10) {
+            skip = test_random() % BUF_SIZE;    // Byte lost on the line
+        } else if (damage < 15) {
+            CHECK(!lidar_parse_byte(&parser, (test_random() & 1) ? HEADER : 0x00, &frame));
+            fed++;                              // Stray byte between frames
+        } else {
+            intact++;
+        }
+        for (uint8_t i = 0; i < BUF_SIZE; i++) {
+            if (i == skip) {
+                continue;
+            }
+            fed++;
+            decoded += lidar_parse_byte(&parser, bytes[i], &frame);
+        }
+        CHECK(accounted(&parser, fed));
+    }
+
+    printf("stream: %lu frames, %lu intact, %lu decoded, %u framing errors, %u checksum errors\n",
+           (unsigned long)STREAM_FRAMES, (unsigned long)intact, (unsigned long)decoded,
+           parser.framingErrors, parser.checksumErrors);
+    CHECK(decoded == parser.frames);
+    CHECK(decoded >= intact * 9 / 10);
+}
+
+int main(void) {
+    test_cases();
+    test_stream();
+    return TEST_DONE("test_lidar");
+}
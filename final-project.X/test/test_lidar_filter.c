@@ -0,0 +1,131 @@
+/*
+ * File:   test_lidar_filter.c
+ * Author: chehj
+ *
+ * Description:
+ * Host test and benchmark of the LIDAR filter: spike and weak-signal
+ * rejection, step response, and the time per frame on a noisy stream.
+ *
+ * Created on December 14, 2024, 10:00 AM
+ */
+
+#include <stdint.h>
+#include "test.h"
+#include "lidar_filter.h"
+
+// Frames in the benchmark stream
+#define BENCH_FRAMES 2000000UL
+
+static uint32_t seed = 12345;
+
+/**
+ * @brief Deterministic pseudo-random numbers for the synthetic streams.
+ *
+ * @return Next value, 0 - 32767.
+ */
+static uint16_t test_random(void) {
+    seed = seed * 1103515245UL + 12345;
+    return (seed >> 16) & 0x7FFF;
+}
+
+/**
+ * @brief Runs one frame through the filter.
+ *
+ * @return Filtered distance, or 0 if the frame was rejected.
+ */
+static uint16_t feed(lidar_filter_t *filter, uint16_t distance, uint16_t strength) {
+    lidar_frame_t frame = { distance, strength, 25, 0 };
+    uint16_t out = 0;
+
+    if (!lidar_filter_update(filter, &frame, &out)) {
+        return 0;
+    }
+    return out;
+}
+
+// Single-frame spikes are removed by the median
+static void test_spikes(void) {
+    lidar_filter_t filter;
+    uint16_t out;
+
+    lidar_filter_init(&filter);
+    for (int i = 0; i < 100; i++) {
+        out = feed(&filter, (i % 7 == 3) ? 30 : 200, 500);
+        CHECK(out >= 198 && out <= 202);
+    }
+}
+
+// Weak, saturated and out of range frames never reach the window
+static void test_rejection(void) {
+    lidar_filter_t filter;
+
+    lidar_filter_init(&filter);
+    for (int i = 0; i < 10; i++) {
+        feed(&filter, 150, 500);
+    }
+    CHECK(feed(&filter, 20, LIDAR_FILTER_MIN_STRENGTH - 1) == 0);
+    CHECK(feed(&filter, 20, 0xFFFF) == 0);
+    CHECK(feed(&filter, 0, 500) == 0);
+    CHECK(feed(&filter, LIDAR_FILTER_MAX_DISTANCE + 1, 500) == 0);
+    CHECK(filter.rejected == 4);
+    CHECK(feed(&filter, 150, 500) == 150);
+}
+
+// A step settles without overshoot in a bounded number of frames
+static void test_step(void) {
+    lidar_filter_t filter;
+    uint16_t out = 0;
+    uint16_t previous = 200;
+    int settled = -1;
+
+    lidar_filter_init(&filter);
+    for (int i = 0; i < 20; i++) {
+        feed(&filter, 200, 500);
+    }
+    for (int i = 0; i < 40; i++) {
+        out = feed(&filter, 100, 500);
+        CHECK(out <= previous && out >= 100);
+        if (settled < 0 && out <= 101) {
+            settled = i + 1;
+        }
+        previous = out;
+    }
+    printf("step 200 -> 100 cm settles to 1 cm in %d frames\n", settled);
+    CHECK(settled > 0 && settled <= 25);
+}
+
+// Time per frame on a noisy stream with occasional bad frames
+static void bench(void) {
+    static lidar_frame_t frames[1024];
+    lidar_filter_t filter;
+    uint16_t out = 0;
+    uint32_t sum = 0;
+    double start;
+    double elapsed;
+
+    for (unsigned i = 0; i < 1024; i++) {
+        frames[i].distance = 300 + test_random() % 21 - 10;
+        frames[i].strength = (test_random() % 50 == 0) ? 20 : 800;
+        frames[i].temperature = 25;
+        frames[i].timestamp = i * 10;
+    }
+
+    lidar_filter_init(&filter);
+    start = test_nanoseconds();
+    for (uint32_t i = 0; i < BENCH_FRAMES; i++) {
+        if (lidar_filter_update(&filter, &frames[i & 1023], &out)) {
+            sum += out;
+        }
+    }
+    elapsed = test_nanoseconds() - start;
+    printf("lidar_filter_update: %.1f ns per frame on the host (checksum %lu)\n",
+           elapsed / BENCH_FRAMES, (unsigned long)sum);
+}
+
+int main(void) {
+    test_spikes();
+    test_rejection();
+    test_step();
+    bench();
+    return TEST_DONE("test_lidar_filter");
+}
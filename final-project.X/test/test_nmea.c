@@ -0,0 +1,202 @@
+/*
+ * File:   test_nmea.c
+ * Author: chehj
+ *
+ * Description:
+ * Host test and throughput benchmark of the streaming NMEA lexer on the
+ * synthetic corpus in data/walk.nmea. Sentence and checksum counts, and the
+ * GGA fields handed out, are compared with a simple line-by-line reference
+ * parser.
+ *
+ * Created on December 14, 2024, 1:30 PM
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "nmea.h"
+
+#ifndef DATA_DIR
+#define DATA_DIR "data/"
+#endif
+
+// Passes over the corpus in the benchmark
+#define BENCH_PASSES 200
+
+// Most GGA sentences kept for the field comparison
+#define MAX_FIXES 1024
+
+static char *corpus;
+static size_t corpusLength;
+
+// GGA latitude fields seen by the lexer and by the reference
+static char lexerLat[MAX_FIXES][NMEA_FIELD_SIZE];
+static char pendingLat[NMEA_FIELD_SIZE];
+static unsigned lexerFixes = 0;
+static char referenceLat[MAX_FIXES][NMEA_FIELD_SIZE];
+static unsigned referenceFixes = 0;
+static unsigned commits = 0;
+
+static void gga_field(uint8_t index, const char *text, uint8_t length) {
+    if (index == 2) {
+        memcpy(pendingLat, text, length + 1);
+    }
+}
+
+static void gga_commit(void) {
+    if (lexerFixes < MAX_FIXES) {
+        strcpy(lexerLat[lexerFixes++], pendingLat);
+    }
+    commits++;
+}
+
+static void other_field(uint8_t index, const char *text, uint8_t length) {
+    (void)index;
+    (void)text;
+    (void)length;
+}
+
+static void other_commit(void) {
+    commits++;
+}
+
+// Same sentence types as gps.c registers
+static const nmea_handler_t handlers[] = {
+    { "GGA", 0, gga_field, gga_commit },
+    { "RMC", 0, other_field, other_commit },
+    { "VTG", 0, other_field, other_commit },
+    { "GSA", 0, other_field, other_commit },
+};
+
+/**
+ * @brief Loads the corpus into memory.
+ *
+ * @return 1 on success.
+ */
+static uint8_t load(const char *path) {
+    FILE *file = fopen(path, "rb");
+
+    if (!file) {
+        printf("cannot open %s\n", path);
+        return 0;
+    }
+    fseek(file, 0, SEEK_END);
+    corpusLength = ftell(file);
+    rewind(file);
+    corpus = malloc(corpusLength + 1);
+    corpusLength = fread(corpus, 1, corpusLength, file);
+    corpus[corpusLength] = 0;
+    fclose(file);
+    return 1;
+}
+
+/**
+ * @brief Checks a corpus line the slow way.
+ *
+ * @param line Sentence without the line ending.
+ * @param[out] valid 1 if the checksum matches.
+ * @return 1 if the sentence is one of the registered types.
+ */
+static uint8_t reference_sentence(const char *line, uint8_t *valid) {
+    const char *star = strchr(line, '*');
+    const char *comma = strchr(line, ',');
+    uint8_t sum = 0;
+    uint8_t registered = 0;
+
+    if (line[0] != '$' || !star || !comma || comma > star) {
+        *valid = 0;
+        return 0;
+    }
+    for (const char *p = line + 1; p < star; p++) {
+        sum ^= (uint8_t)*p;
+    }
+    *valid = strlen(star) == 3 && strtoul(star + 1, 0, 16) == sum;
+
+    for (unsigned i = 0; i < sizeof(handlers) / sizeof(handlers[0]); i++) {
+        registered |= (comma - line == 6 && strncmp(line + 3, handlers[i].type, 3) == 0);
+    }
+
+    // Latitude of a valid GGA: the field after the time
+    if (registered && *valid && strncmp(line + 3, "GGA", 3) == 0 && referenceFixes < MAX_FIXES) {
+        const char *lat = strchr(comma + 1, ',') + 1;
+        size_t length = strcspn(lat, ",");
+
+        memcpy(referenceLat[referenceFixes], lat, length);
+        referenceLat[referenceFixes++][length] = 0;
+    }
+    return registered;
+}
+
+// The lexer agrees with the reference on every sentence in the corpus
+static void test_corpus(void) {
+    nmea_lexer_t lexer;
+    unsigned valid = 0;
+    unsigned invalid = 0;
+    char *copy = strdup(corpus);
+
+    for (char *line = strtok(copy, "\r\n"); line; line = strtok(0, "\r\n")) {
+        uint8_t ok;
+
+        if (reference_sentence(line, &ok)) {
+            ok ? valid++ : invalid++;
+        }
+    }
+    free(copy);
+
+    nmea_init(&lexer, handlers, sizeof(handlers) / sizeof(handlers[0]));
+    for (size_t i = 0; i < corpusLength; i++) {
+        nmea_feed(&lexer, corpus[i]);
+    }
+
+    printf("corpus: %lu bytes, %u registered sentences, %u with a bad checksum\n",
+           (unsigned long)corpusLength, valid + invalid, invalid);
+    CHECK(invalid > 0);
+    CHECK(lexer.sentences == valid);
+    CHECK(commits == valid);
+    CHECK(lexer.checksumErrors == invalid);
+    CHECK(lexer.truncatedFields == 0);
+    CHECK(lexerFixes == referenceFixes);
+    for (unsigned i = 0; i < lexerFixes && i < referenceFixes; i++) {
+        CHECK(strcmp(lexerLat[i], referenceLat[i]) == 0);
+    }
+}
+
+// Number parsing used on the fields
+static void test_numbers(void) {
+    CHECK(nmea_parse_uint("08", 2) == 8);
+    CHECK(nmea_parse_uint("", 0) == 0);
+    CHECK(nmea_parse_fixed("123519.5", 8, 3) == 123519500UL);
+    CHECK(nmea_parse_fixed("0.92", 4, 2) == 92);
+    CHECK(nmea_parse_fixed("4304.481817", 11, 5) == 430448181UL);
+    CHECK(nmea_parse_fixed("12", 2, 2) == 1200);
+}
+
+// Bytes per second through nmea_feed()
+static void bench(void) {
+    nmea_lexer_t lexer;
+    double start;
+    double elapsed;
+
+    nmea_init(&lexer, handlers, sizeof(handlers) / sizeof(handlers[0]));
+    start = test_nanoseconds();
+    for (int pass = 0; pass < BENCH_PASSES; pass++) {
+        for (size_t i = 0; i < corpusLength; i++) {
+            nmea_feed(&lexer, corpus[i]);
+        }
+    }
+    elapsed = test_nanoseconds() - start;
+    printf("nmea_feed: %.1f ns per byte, %.1f MB/s on the host\n",
+           elapsed / ((double)corpusLength * BENCH_PASSES),
+           (double)corpusLength * BENCH_PASSES * 1e3 / elapsed);
+}
+
+int main(void) {
+    if (!load(DATA_DIR "walk.nmea")) {
+        return 1;
+    }
+    test_numbers();
+    test_corpus();
+    bench();
+    return TEST_DONE("test_nmea");
+}
@@ -0,0 +1,211 @@
+/*
+ * File:   test_ring.c
+ * Author: chehj
+ *
+ * Description:
+ * Host tests of the SPSC ring: single-threaded edge cases, a two-thread
+ * stress test with one producer and one consumer, and timings per operation.
+ *
+ * The stress test relies on the host keeping stores in order and loads in
+ * order, as x86 does and the AVR trivially does; RING_BARRIER() only stops
+ * the compiler. On a weakly ordered host it would need real fences.
+ *
+ * AVR instruction counts for ring_push(), ring_pop(), ring_write() and
+ * ring_read() come from "make avr-disasm", which needs avr-gcc.
+ *
+ * Created on December 15, 2024, 9:00 AM
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <string.h>
+#include "test.h"
+#include "ring.h"
+
+// Bytes passed through the rings in the stress test. The 2-byte ring swaps
+// threads on almost every byte, so it gets fewer.
+#define STRESS_BYTES 20000000UL
+#define STRESS_BYTES_TINY 1000000UL
+
+// Operations timed in the benchmark
+#define BENCH_OPS 20000000UL
+
+static ring_t stressRing;
+static uint32_t stressBytes;
+static uint32_t stressErrors;
+
+// Empty and full rings, wrapping and the one free slot
+static void test_edges(void) {
+    uint8_t storage[8];
+    uint8_t out[16];
+    uint8_t value = 0;
+    ring_t ring;
+
+    ring_init(&ring, storage, sizeof(storage));
+    CHECK(ring_count(&ring) == 0);
+    CHECK(ring_space(&ring) == 7);
+    CHECK(!ring_pop(&ring, &value));
+
+    for (uint8_t i = 0; i < 7; i++) {
+        CHECK(ring_push(&ring, i));
+    }
+    CHECK(!ring_push(&ring, 99));
+    CHECK(ring_count(&ring) == 7 && ring_space(&ring) == 0);
+    CHECK(ring_pop(&ring, &value) && value == 0);
+
+    // Bulk copies across the end of the storage
+    CHECK(ring_write(&ring, (const uint8_t *)"ab", 2) == 1);
+    CHECK(ring_read(&ring, out, sizeof(out)) == 7);
+    CHECK(memcmp(out, "\x01\x02\x03\x04\x05\x06" "a", 7) == 0);
+    CHECK(ring_write(&ring, (const uint8_t *)"0123456789", 10) == 7);
+    CHECK(ring_read(&ring, out, 3) == 3 && memcmp(out, "012", 3) == 0);
+    CHECK(ring_read(&ring, out, 16) == 4 && memcmp(out, "3456", 4) == 0);
+    CHECK(ring_read(&ring, out, 16) == 0);
+
+    // 256-byte ring uses the whole index range
+    {
+        static uint8_t big[256];
+
+        ring_init(&ring, big, sizeof(big));
+        CHECK(ring_space(&ring) == 255);
+        for (int i = 0; i < 1000; i++) {
+            CHECK(ring_push(&ring, (uint8_t)i));
+            CHECK(ring_pop(&ring, &value) && value == (uint8_t)i);
+        }
+    }
+}
+
+// Event codes come out in order and a full queue refuses more
+static void test_events(void) {
+    uint8_t storage[4];
+    event_queue_t queue;
+    uint8_t event;
+
+    ring_init(&queue, storage, sizeof(storage));
+    CHECK(event_post(&queue, 1) && event_post(&queue, 2) && event_post(&queue, 3));
+    CHECK(!event_post(&queue, 4));
+    CHECK(event_get(&queue, &event) && event == 1);
+    CHECK(event_get(&queue, &event) && event == 2);
+    CHECK(event_get(&queue, &event) && event == 3);
+    CHECK(!event_get(&queue, &event));
+}
+
+// Writes a counting sequence with single pushes and bulk writes of varying size
+static void *producer(void *arg) {
+    uint8_t chunk[64];
+    uint32_t sent = 0;
+    uint32_t pass = 0;
+
+    (void)arg;
+    while (sent < stressBytes) {
+        uint8_t length = (pass++ % 5 == 0) ? 1 : (uint8_t)(pass % sizeof(chunk)) + 1;
+        uint8_t written;
+
+        if (length > stressBytes - sent) {
+            length = stressBytes - sent;
+        }
+        for (uint8_t i = 0; i < length; i++) {
+            chunk[i] = (uint8_t)(sent + i);
+        }
+        if (length == 1) {
+            written = ring_push(&stressRing, chunk[0]);
+        } else {
+            written = ring_write(&stressRing, chunk, length);
+        }
+        sent += written;
+        if (written < length) {
+            sched_yield(); // Full, let the consumer run
+        }
+    }
+    return 0;
+}
+
+// Reads with single pops and bulk reads and checks the sequence
+static void *consumer(void *arg) {
+    uint8_t chunk[48];
+    uint32_t received = 0;
+    uint32_t pass = 0;
+
+    (void)arg;
+    while (received < stressBytes) {
+        uint8_t got;
+
+        if (pass++ % 3 == 0) {
+            got = ring_pop(&stressRing, chunk);
+        } else {
+            got = ring_read(&stressRing, chunk, (uint8_t)(pass % sizeof(chunk)) + 1);
+        }
+        for (uint8_t i = 0; i < got; i++) {
+            if (chunk[i] != (uint8_t)(received + i)) {
+                stressErrors++;
+            }
+        }
+        received += got;
+        if (got == 0) {
+            sched_yield(); // Empty, let the producer run
+        }
+    }
+    return 0;
+}
+
+// One producer thread and one consumer thread on rings of several sizes
+static void test_stress(void) {
+    static const uint16_t sizes[] = { 2, 64, 256 };
+    static uint8_t storage[256];
+
+    for (unsigned i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        pthread_t threads[2];
+        double start = test_nanoseconds();
+
+        ring_init(&stressRing, storage, sizes[i]);
+        stressBytes = (sizes[i] == 2) ? STRESS_BYTES_TINY : STRESS_BYTES;
+        stressErrors = 0;
+        pthread_create(&threads[0], 0, producer, 0);
+        pthread_create(&threads[1], 0, consumer, 0);
+        pthread_join(threads[0], 0);
+        pthread_join(threads[1], 0);
+
+        printf("stress: %lu bytes through a %3u-byte ring, %lu errors, %.1f s\n",
+               (unsigned long)stressBytes, sizes[i], (unsigned long)stressErrors, (test_nanoseconds() - start) / 1e9);
+        CHECK(stressErrors == 0);
+        CHECK(ring_count(&stressRing) == 0);
+    }
+}
+
+// Host time per operation
+static void bench(void) {
+    static uint8_t storage[64];
+    uint8_t block[32];
+    uint8_t value = 0;
+    uint32_t sum = 0;
+    ring_t ring;
+    double start;
+
+    ring_init(&ring, storage, sizeof(storage));
+    start = test_nanoseconds();
+    for (uint32_t i = 0; i < BENCH_OPS; i++) {
+        ring_push(&ring, (uint8_t)i);
+        ring_pop(&ring, &value);
+        sum += value;
+    }
+    printf("ring_push + ring_pop: %.2f ns per pair on the host\n",
+           (test_nanoseconds() - start) / BENCH_OPS);
+
+    memset(block, 1, sizeof(block));
+    start = test_nanoseconds();
+    for (uint32_t i = 0; i < BENCH_OPS / sizeof(block); i++) {
+        ring_write(&ring, block, sizeof(block));
+        sum += ring_read(&ring, block, sizeof(block));
+    }
+    printf("ring_write + ring_read: %.2f ns per byte on the host (checksum %lu)\n",
+           (test_nanoseconds() - start) / BENCH_OPS, (unsigned long)sum);
+}
+
+int main(void) {
+    test_edges();
+    test_events();
+    test_stress();
+    bench();
+    return TEST_DONE("test_ring");
+}
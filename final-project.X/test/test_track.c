@@ -0,0 +1,175 @@
+/*
+ * File:   test_track.c
+ * Author: chehj
+ *
+ * Description:
+ * Replays the GGA fixes of data/walk.nmea through the position filter and
+ * counts how often the closer/farther decision of nav_steer() in gps.c flips,
+ * once on the raw fixes and once on the smoothed ones.
+ *
+ * Created on December 14, 2024, 4:30 PM
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "test.h"
+#include "gps.h"
+#include "geo.h"
+#include "track.h"
+
+#ifndef DATA_DIR
+#define DATA_DIR "data/"
+#endif
+
+// Walk phases of the corpus, see data/gen_walk.py (s)
+#define WALK_START 120
+#define WALK_END 360
+
+// Destination 400 m ahead along the walking direction (north-east)
+#define DEST_EAST 28284L
+#define DEST_NORTH 28284L
+
+#define DECISION_NONE 0
+#define DECISION_CLOSER 1
+#define DECISION_FARTHER 2
+
+// Closer/farther decision of nav_steer() and its flip counts
+typedef struct {
+    int32_t previous;       // Distance of the last decision, -1 before the first fix (cm)
+    uint8_t decision;       // DECISION_* value
+    uint16_t flips;         // Changes between closer and farther
+    uint16_t standingFlips; // Flips while the walker stood still
+} decision_t;
+
+static gps_coord_t fixLat;
+static gps_coord_t fixLon;
+static uint16_t fixHdop;
+static uint32_t fixTime;
+
+static geo_origin_t origin;
+static uint8_t haveOrigin = 0;
+static uint32_t firstTime;
+static track_t track;
+static decision_t raw[2];
+static decision_t smoothed[2];
+static const uint32_t deadbands[2] = { 0, GPS_DISTANCE_DEADBAND };
+static uint16_t fixes = 0;
+
+static void gga_field(uint8_t index, const char *text, uint8_t length) {
+    switch (index) {
+    case 1:
+        fixTime = nmea_parse_fixed(text, length, 3);
+        break;
+    case 2:
+        fixLat = convert_to_decimal(text, 'N');
+        break;
+    case 3:
+        if (text[0] == 'S') fixLat = -fixLat;
+        break;
+    case 4:
+        fixLon = convert_to_decimal(text, 'E');
+        break;
+    case 5:
+        if (text[0] == 'W') fixLon = -fixLon;
+        break;
+    case 8:
+        fixHdop = nmea_parse_fixed(text, length, 2);
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Applies the distance comparison of nav_steer().
+ *
+ * @param d Decision state.
+ * @param distance Distance to the destination (cm).
+ * @param deadband Change needed before the decision moves (cm).
+ * @param standing The walker is standing still.
+ */
+static void decide(decision_t *d, uint32_t distance, uint32_t deadband, uint8_t standing) {
+    uint8_t decision = DECISION_NONE;
+
+    if (d->previous < 0) {
+        d->previous = (int32_t)distance;
+        return;
+    }
+    if (distance + deadband < (uint32_t)d->previous) {
+        decision = DECISION_CLOSER;
+    } else if (distance > (uint32_t)d->previous + deadband) {
+        decision = DECISION_FARTHER;
+    }
+    if (decision == DECISION_NONE) {
+        return;
+    }
+    d->previous = (int32_t)distance;
+    if (d->decision != DECISION_NONE && decision != d->decision) {
+        d->flips++;
+        d->standingFlips += standing;
+    }
+    d->decision = decision;
+}
+
+static void gga_commit(void) {
+    geo_point_t dest = { DEST_EAST, DEST_NORTH };
+    geo_point_t position;
+    uint32_t seconds = fixTime / 1000;
+    uint32_t now = ((seconds / 10000) * 3600 + (seconds / 100 % 100) * 60 + seconds % 100) * 1000 + fixTime % 1000;
+    uint8_t standing;
+
+    if (!haveOrigin) {
+        geo_set_origin(&origin, fixLat, fixLon);
+        firstTime = now;
+        haveOrigin = 1;
+    }
+    standing = (now - firstTime) / 1000 < WALK_START || (now - firstTime) / 1000 >= WALK_END;
+
+    CHECK(geo_project(&origin, fixLat, fixLon, &position));
+    track_update(&track, &position, fixHdop, now);
+    for (int i = 0; i < 2; i++) {
+        decide(&raw[i], geo_distance(&position, &dest), deadbands[i], standing);
+    }
+    track_position(&track, &position);
+    for (int i = 0; i < 2; i++) {
+        decide(&smoothed[i], geo_distance(&position, &dest), deadbands[i], standing);
+    }
+    fixes++;
+}
+
+static const nmea_handler_t handlers[] = {
+    { "GGA", 0, gga_field, gga_commit },
+};
+
+int main(void) {
+    FILE *file = fopen(DATA_DIR "walk.nmea", "rb");
+    nmea_lexer_t lexer;
+    int c;
+
+    if (!file) {
+        printf("cannot open " DATA_DIR "walk.nmea\n");
+        return 1;
+    }
+    track_init(&track);
+    for (int i = 0; i < 2; i++) {
+        raw[i].previous = -1;
+        smoothed[i].previous = -1;
+    }
+    nmea_init(&lexer, handlers, 1);
+    while ((c = fgetc(file)) != EOF) {
+        nmea_feed(&lexer, c);
+    }
+    fclose(file);
+
+    printf("replayed %u fixes, %u filter restarts\n", fixes, track.resets);
+    for (int i = 0; i < 2; i++) {
+        printf("deadband %3lu cm: %3u flips raw (%3u standing), %3u flips filtered (%3u standing)\n",
+               (unsigned long)deadbands[i], raw[i].flips, raw[i].standingFlips,
+               smoothed[i].flips, smoothed[i].standingFlips);
+        CHECK(smoothed[i].flips <= raw[i].flips);
+    }
+    CHECK(fixes > 400);
+    CHECK(track.resets == 0);
+    CHECK(smoothed[0].flips * 2 <= raw[0].flips); // The filter alone halves the flips at least
+    return TEST_DONE("test_track");
+}
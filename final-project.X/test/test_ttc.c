@@ -0,0 +1,174 @@
+/*
+ * File:   test_ttc.c
+ * Author: chehj
+ *
+ * Description:
+ * Host test of the time-to-collision estimator on synthetic approach
+ * profiles. Frames go through the LIDAR filter first and are handled the way
+ * task_obstacle() in main.c handles them, including the expiry when the
+ * filter stops accepting frames.
+ *
+ * Created on December 14, 2024, 11:00 AM
+ */
+
+#include <stdint.h>
+#include "test.h"
+#include "lidar_filter.h"
+#include "ttc.h"
+
+// Interval between triggered LIDAR measurements, as in main.c (ms)
+#define FRAME_MS 20
+
+// Sensor noise, uniform in +/- this many cm
+#define NOISE_CM 3
+
+static uint32_t seed = 4321;
+static lidar_filter_t filter;
+static ttc_t ttc;
+static uint8_t state;
+static uint32_t now;
+
+/**
+ * @brief Deterministic pseudo-random noise.
+ *
+ * @return Value in -NOISE_CM .. NOISE_CM.
+ */
+static int16_t noise(void) {
+    seed = seed * 1103515245UL + 12345;
+    return (int16_t)((seed >> 16) % (2 * NOISE_CM + 1)) - NOISE_CM;
+}
+
+// Start a profile with an empty pipeline
+static void reset(void) {
+    lidar_filter_init(&filter);
+    ttc_init(&ttc);
+    state = TTC_CLEAR;
+    now = 1000;
+}
+
+/**
+ * @brief Runs one frame through the filter and the estimator.
+ *
+ * @param distance True distance in cm.
+ * @param strength Signal strength reported for the frame.
+ */
+static void frame(int32_t distance, uint16_t strength) {
+    lidar_frame_t f = { (uint16_t)(distance + noise()), strength, 25, now };
+    uint16_t filtered;
+
+    if (lidar_filter_update(&filter, &f, &filtered)) {
+        state = ttc_update(&ttc, filtered, now);
+    } else if (ttc_expire(&ttc, now)) {
+        lidar_filter_init(&filter);
+        state = TTC_CLEAR;
+    }
+    now += FRAME_MS;
+}
+
+/**
+ * @brief Walks straight at a wall and reports how much warning the alert gave.
+ *
+ * @param speed Walking speed in cm/s.
+ * @return Time left before impact when the alert was raised (ms), 0 if never.
+ */
+static uint32_t approach(int32_t speed) {
+    int32_t start = speed * 5 + 300;
+
+    reset();
+    for (uint32_t t = 0; ; t += FRAME_MS) {
+        int32_t distance = start - (int32_t)(speed * t / 1000);
+
+        if (distance <= 0) {
+            return 0;
+        }
+        frame(distance, 800);
+        if (state == TTC_APPROACHING) {
+            return (uint32_t)distance * 1000 / speed;
+        }
+    }
+}
+
+// The warning time stays near TTC_ALERT_MS at any walking speed
+static void test_approach(void) {
+    static const int32_t speeds[] = { 40, 70, 100, 150, 200 };
+
+    for (unsigned i = 0; i < sizeof(speeds) / sizeof(speeds[0]); i++) {
+        uint32_t warning = approach(speeds[i]);
+
+        printf("approach at %3ld cm/s: alert %4lu ms before impact (a fixed 100 cm threshold gives %4ld ms)\n",
+               (long)speeds[i], (unsigned long)warning, (long)(100000 / speeds[i]));
+        CHECK(warning >= TTC_ALERT_MS - 500 && warning <= TTC_ALERT_MS + 100);
+    }
+}
+
+// Standing still in front of an object is not an approach
+static void test_standing(void) {
+    uint8_t alerted = 0;
+
+    reset();
+    for (int i = 0; i < 1500; i++) {
+        frame(100, 800);
+        alerted |= (state != TTC_CLEAR);
+    }
+    CHECK(!alerted);
+
+    // Unless it is inside the guard distance
+    reset();
+    for (int i = 0; i < 50; i++) {
+        frame(TTC_GUARD_DISTANCE - 10, 800);
+    }
+    CHECK(state == TTC_APPROACHING);
+}
+
+// Backing away after an alert reports the object receding, then clears
+static void test_recede(void) {
+    uint8_t receding = 0;
+
+    CHECK(approach(100) > 0);
+    for (int i = 0; i < 50; i++) {
+        frame(200, 800); // Stop
+    }
+    for (int32_t t = 0; t < 3000; t += FRAME_MS) {
+        frame(200 + 60 * t / 1000, 800);
+        receding |= (state == TTC_RECEDING);
+    }
+    CHECK(receding);
+    CHECK(state == TTC_CLEAR);
+}
+
+// Turning towards open space clears the alert although no frame is accepted
+static void test_open_space(void) {
+    uint32_t lost;
+
+    CHECK(approach(100) > 0);
+    CHECK(state == TTC_APPROACHING);
+    lost = now;
+    while (state != TTC_CLEAR && now - lost < 5000) {
+        frame(LIDAR_FILTER_MAX_DISTANCE + 300, 800); // Beyond the sensor's range
+    }
+    printf("open space: alert cleared %lu ms after the last return\n", (unsigned long)(now - lost));
+    CHECK(state == TTC_CLEAR);
+    CHECK(now - lost <= TTC_STALE_MS + FRAME_MS);
+
+    // Same with returns too weak to use
+    CHECK(approach(100) > 0);
+    lost = now;
+    while (state != TTC_CLEAR && now - lost < 5000) {
+        frame(400, LIDAR_FILTER_MIN_STRENGTH / 2);
+    }
+    CHECK(state == TTC_CLEAR);
+
+    // The next object starts from a fresh window, not the old one
+    for (int i = 0; i < 100; i++) {
+        frame(600, 800);
+        CHECK(state == TTC_CLEAR);
+    }
+}
+
+int main(void) {
+    test_approach();
+    test_standing();
+    test_recede();
+    test_open_space();
+    return TEST_DONE("test_ttc");
+}
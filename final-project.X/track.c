@@ -0,0 +1,160 @@
+/*
+ * File:   track.c
+ * Author: chehj
+ *
+ * Created on December 11, 2024, 9:15 AM
+ */
+
+#include <avr/io.h>
+#include "track.h"
+
+track_t navTrack;
+uint16_t trackMaxCycles = 0;
+uint16_t trackBudgetOverruns = 0;
+
+// Steady-state alpha-beta gains (Q12) by HDOP, for fixes 1 s apart, a walker
+// manoeuvring at sigma_a = 0.5 m/s^2 and sigma_m = 3 m of position noise per
+// unit of HDOP. Each row is evaluated at its upper HDOP bound, the last one
+// at HDOP 10, with Kalata's tracking index:
+//   lambda = sigma_a * T^2 / (sigma_m * HDOP)
+//   r = (4 + lambda - sqrt(8 * lambda + lambda^2)) / 4
+//   alpha = 1 - r^2
+//   beta = 2 * (2 - alpha) - 4 * sqrt(1 - alpha)
+// and both gains scaled by 4096 and rounded.
+static const struct {
+    uint16_t hdop;              // Upper HDOP bound of this row (DOP * 100)
+    uint16_t alpha;
+    uint16_t beta;
+} trackGains[] = {
+    {   50, 2276,  910 },
+    {  100, 1792,  512 },
+    {  150, 1537,  360 },
+    {  200, 1371,  278 },
+    {  300, 1160,  193 },
+    {  400, 1026,  148 },
+    {  600,  860,  101 },
+    { 0xFFFF, 683,  62 },
+};
+
+
+/**
+ * @brief Advances one axis of the filter.
+ *
+ * @param position Position state (cm).
+ * @param velocity Velocity state (cm/s, Q8).
+ * @param measured Measured position (cm).
+ * @param dt Time since the last update (ms, 1 - TRACK_MAX_GAP_MS).
+ * @param alpha Position gain (Q12).
+ * @param beta Velocity gain (Q12).
+ * @return 1 if the fix was accepted, 0 if it is too far from the prediction.
+ */
+static uint8_t track_axis(int32_t *position, int32_t *velocity, int32_t measured,
+                          uint16_t dt, uint16_t alpha, uint16_t beta) {
+    // |velocity| <= TRACK_MAX_SPEED << 8 and dt <= 5000, so the product fits in 32 bits
+    int32_t predicted = *position + (*velocity * (int32_t)dt) / (1000L << TRACK_VELOCITY_SHIFT);
+    int32_t residual = measured - predicted;
+    int32_t v;
+    
+    if (residual > TRACK_RESET_CM || residual < -TRACK_RESET_CM) {
+        return 0;
+    }
+    
+    *position = predicted + ((residual * (int32_t)alpha) >> TRACK_GAIN_SHIFT);
+    
+    // beta * residual / dt in cm/s, Q8: 1000 * 256 / 4096 = 125 / 2
+    v = *velocity + (residual * (int32_t)beta * 125) / (2 * (int32_t)dt);
+    if (v > ((int32_t)TRACK_MAX_SPEED << TRACK_VELOCITY_SHIFT)) v = (int32_t)TRACK_MAX_SPEED << TRACK_VELOCITY_SHIFT;
+    if (v < -((int32_t)TRACK_MAX_SPEED << TRACK_VELOCITY_SHIFT)) v = -((int32_t)TRACK_MAX_SPEED << TRACK_VELOCITY_SHIFT);
+    *velocity = v;
+    return 1;
+}
+
+
+// Clear the filter
+void track_init(track_t *track) {
+    track->initialized = 0;
+    track->resets = 0;
+}
+
+// Advance the filter to a new fix
+void track_update(track_t *track, const geo_point_t *fix, uint16_t hdop, uint32_t now) {
+    uint16_t start = TCB1.CNT;
+    uint16_t cycles;
+    uint32_t dt = now - track->time;
+    uint8_t row = 0;
+    int32_t east = track->east;
+    int32_t north = track->north;
+    int32_t vEast = track->vEast;
+    int32_t vNorth = track->vNorth;
+    
+    if (hdop == 0) {
+        hdop = TRACK_DEFAULT_HDOP;
+    }
+    while (hdop > trackGains[row].hdop) {
+        row++;
+    }
+    
+    if (dt == 0) {
+        dt = 1;
+    }
+    
+    // Both axes must accept the fix, otherwise restart at the fix
+    if (!track->initialized || dt > TRACK_MAX_GAP_MS ||
+        !track_axis(&east, &vEast, fix->east, dt, trackGains[row].alpha, trackGains[row].beta) ||
+        !track_axis(&north, &vNorth, fix->north, dt, trackGains[row].alpha, trackGains[row].beta)) {
+        if (track->initialized) {
+            track->resets++;
+        }
+        east = fix->east;
+        north = fix->north;
+        vEast = 0;
+        vNorth = 0;
+        track->initialized = 1;
+    }
+    
+    track->east = east;
+    track->north = north;
+    track->vEast = vEast;
+    track->vNorth = vNorth;
+    track->time = now;
+    
+    cycles = TCB1.CNT - start;
+    if (cycles > trackMaxCycles) {
+        trackMaxCycles = cycles;
+    }
+    if (cycles > TRACK_CYCLE_BUDGET) {
+        trackBudgetOverruns++;
+    }
+}
+
+// Smoothed position
+void track_position(const track_t *track, geo_point_t *position) {
+    position->east = track->east;
+    position->north = track->north;
+}
+
+// Extrapolate the smoothed position
+uint8_t track_predict(const track_t *track, uint32_t now, geo_point_t *position) {
+    uint32_t dt = now - track->time;
+    
+    if (!track->initialized || dt > TRACK_PREDICT_MAX_MS) {
+        return 0;
+    }
+    
+    position->east = track->east + (track->vEast * (int32_t)dt) / (1000L << TRACK_VELOCITY_SHIFT);
+    position->north = track->north + (track->vNorth * (int32_t)dt) / (1000L << TRACK_VELOCITY_SHIFT);
+    return 1;
+}
+
+// Smoothed ground speed
+uint16_t track_speed(const track_t *track) {
+    geo_point_t zero = { 0, 0 };
+    geo_point_t velocity = { track->vEast >> TRACK_VELOCITY_SHIFT, track->vNorth >> TRACK_VELOCITY_SHIFT };
+    
+    return (uint16_t)geo_distance(&zero, &velocity);
+}
+
+// Smoothed course over ground
+uint16_t track_course(const track_t *track) {
+    return geo_atan2(track->vEast, track->vNorth);
+}
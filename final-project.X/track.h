@@ -0,0 +1,126 @@
+/*
+ * File:   track.h
+ * Author: chehj
+ *
+ * Description:
+ * Position smoothing. A fixed-point alpha-beta filter (a steady-state
+ * constant-velocity Kalman filter) over fixes projected into the route's
+ * local frame. The gains are picked from the fix's HDOP, so poor fixes move
+ * the estimate less than good ones.
+ *
+ * Created on December 11, 2024, 9:15 AM
+ */
+
+#ifndef TRACK_H
+#define TRACK_H
+
+#include <stdint.h>
+#include "geo.h"
+
+// Fraction bits of the velocity state
+#define TRACK_VELOCITY_SHIFT 8
+
+// Gain fraction bits
+#define TRACK_GAIN_SHIFT 12
+
+// HDOP assumed when the receiver has not reported one (DOP * 100)
+#ifndef TRACK_DEFAULT_HDOP
+#define TRACK_DEFAULT_HDOP 200
+#endif
+
+// Restart the filter after a gap longer than this (ms)
+#ifndef TRACK_MAX_GAP_MS
+#define TRACK_MAX_GAP_MS 5000
+#endif
+
+// Restart the filter when a fix lands further than this from the prediction (cm)
+#ifndef TRACK_RESET_CM
+#define TRACK_RESET_CM 5000
+#endif
+
+// Fastest plausible walker (cm/s), caps the velocity estimate
+#ifndef TRACK_MAX_SPEED
+#define TRACK_MAX_SPEED 1000
+#endif
+
+// Longest extrapolation past the last fix (ms)
+#ifndef TRACK_PREDICT_MAX_MS
+#define TRACK_PREDICT_MAX_MS 3000
+#endif
+
+// Cycle budget for one track_update() call (CPU cycles)
+#ifndef TRACK_CYCLE_BUDGET
+#define TRACK_CYCLE_BUDGET 4000
+#endif
+
+// Filter state
+typedef struct {
+    int32_t east;               // Smoothed position (cm)
+    int32_t north;
+    int32_t vEast;              // Velocity (cm/s, TRACK_VELOCITY_SHIFT fraction bits)
+    int32_t vNorth;
+    uint32_t time;              // Time of the last update (ms)
+    uint8_t initialized;        // 0 until the first fix
+    uint16_t resets;            // Restarts after gaps or outliers
+} track_t;
+
+// Filter run on the navigation fixes
+extern track_t navTrack;
+
+// Longest track_update() run time seen and the calls over budget (measured with TCB1)
+extern uint16_t trackMaxCycles;
+extern uint16_t trackBudgetOverruns;
+
+
+/**
+ * @brief Clears the filter; the next fix restarts it.
+ *
+ * @param track Filter state.
+ */
+void track_init(track_t *track);
+
+/**
+ * @brief Advances the filter to a new fix.
+ *
+ * @param track Filter state.
+ * @param fix Fix in the local frame.
+ * @param hdop Horizontal dilution of precision of the fix (DOP * 100), 0 if unknown.
+ * @param now Time of the fix (ms).
+ */
+void track_update(track_t *track, const geo_point_t *fix, uint16_t hdop, uint32_t now);
+
+/**
+ * @brief Smoothed position.
+ *
+ * @param track Filter state.
+ * @param[out] position Position in the local frame.
+ */
+void track_position(const track_t *track, geo_point_t *position);
+
+/**
+ * @brief Extrapolates the smoothed position to a later time.
+ *
+ * @param track Filter state.
+ * @param now Time to predict for (ms).
+ * @param[out] position Predicted position in the local frame.
+ * @return 1 on success, 0 if the last fix is older than TRACK_PREDICT_MAX_MS.
+ */
+uint8_t track_predict(const track_t *track, uint32_t now, geo_point_t *position);
+
+/**
+ * @brief Smoothed ground speed.
+ *
+ * @param track Filter state.
+ * @return Speed in cm/s.
+ */
+uint16_t track_speed(const track_t *track);
+
+/**
+ * @brief Smoothed course over ground.
+ *
+ * @param track Filter state.
+ * @return Course in 0.01 degrees clockwise from north (0 - 35999).
+ */
+uint16_t track_course(const track_t *track);
+
+#endif /* TRACK_H */
@@ -0,0 +1,121 @@
+/*
+ * File:   ttc.c
+ * Author: chehj
+ *
+ * Created on December 7, 2024, 2:30 PM
+ */
+
+#include "ttc.h"
+
+
+/**
+ * @brief Resets the estimator.
+ *
+ * @param ttc Estimator state.
+ */
+void ttc_init(ttc_t *ttc) {
+    ttc->index = 0;
+    ttc->count = 0;
+    ttc->speed = 0;
+    ttc->ttc = TTC_INFINITE;
+    ttc->state = TTC_CLEAR;
+    ttc->lastAlert = 0;
+    ttc->lastSample = 0;
+}
+
+/**
+ * @brief Estimates the closing speed across the sample history.
+ *
+ * @param ttc Estimator state.
+ * @return Closing speed in cm/s, negative when the distance is growing.
+ */
+static int16_t ttc_speed(const ttc_t *ttc) {
+    uint8_t oldest;
+    uint32_t dt;
+    int32_t dd;
+    
+    if (ttc->count < 2) {
+        return 0;
+    }
+    
+    oldest = ttc->index + 1;
+    if (oldest >= ttc->count) {
+        oldest = 0;
+    }
+    
+    dt = ttc->time[ttc->index] - ttc->time[oldest];
+    dd = (int32_t)ttc->distance[oldest] - ttc->distance[ttc->index];
+    if (dt == 0) {
+        return 0;
+    }
+    
+    return (int16_t)(dd * 1000 / (int32_t)dt);
+}
+
+/**
+ * @brief Adds a filtered distance sample and updates the obstacle state.
+ * The history only takes a sample every TTC_SAMPLE_MS, so the speed is always
+ * measured over several hundred milliseconds regardless of the frame rate.
+ *
+ * @param ttc Estimator state.
+ * @param distance Filtered distance in cm.
+ * @param now Timestamp of the LIDAR frame in ms.
+ * @return The obstacle state (TTC_CLEAR, TTC_APPROACHING or TTC_RECEDING).
+ */
+uint8_t ttc_update(ttc_t *ttc, uint16_t distance, uint32_t now) {
+    uint32_t ttcMs;
+    
+    ttc->lastSample = now;
+    
+    // Only store a new sample once the sample interval has passed
+    if (ttc->count > 0 && (now - ttc->time[ttc->index]) < TTC_SAMPLE_MS) {
+        return ttc->state;
+    }
+    
+    if (ttc->count > 0 && ++ttc->index == TTC_HISTORY) {
+        ttc->index = 0;
+    }
+    ttc->time[ttc->index] = now;
+    ttc->distance[ttc->index] = distance;
+    if (ttc->count < TTC_HISTORY) {
+        ttc->count++;
+    }
+    
+    ttc->speed = ttc_speed(ttc);
+    
+    // Time to collision at the current closing speed
+    if (ttc->speed >= TTC_MIN_SPEED) {
+        ttcMs = (uint32_t)distance * 1000 / (uint16_t)ttc->speed;
+        ttc->ttc = (ttcMs < TTC_INFINITE) ? (uint16_t)ttcMs : TTC_INFINITE;
+    } else {
+        ttc->ttc = TTC_INFINITE;
+    }
+    
+    // Alert bands with hysteresis so a single sample can not toggle the alert
+    if (distance < TTC_GUARD_DISTANCE || ttc->ttc <= TTC_ALERT_MS) {
+        ttc->state = TTC_APPROACHING;
+        ttc->lastAlert = now;
+    } else if (ttc->speed <= -TTC_MIN_SPEED && ttc->lastAlert != 0 &&
+               (now - ttc->lastAlert) < TTC_RECEDE_HOLD_MS) {
+        // The object we alerted on is moving away again
+        ttc->state = TTC_RECEDING;
+    } else if (ttc->state != TTC_APPROACHING || ttc->ttc > TTC_CLEAR_MS) {
+        ttc->state = TTC_CLEAR;
+    }
+    
+    return ttc->state;
+}
+
+// Forget the history once samples have stopped
+uint8_t ttc_expire(ttc_t *ttc, uint32_t now) {
+    if (ttc->count == 0 || (now - ttc->lastSample) < TTC_STALE_MS) {
+        return 0;
+    }
+    
+    ttc->count = 0;
+    ttc->index = 0;
+    ttc->speed = 0;
+    ttc->ttc = TTC_INFINITE;
+    ttc->state = TTC_CLEAR;
+    return 1;
+}
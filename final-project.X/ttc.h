@@ -0,0 +1,110 @@
+/*
+ * File:   ttc.h
+ * Author: chehj
+ *
+ * Description:
+ * Time-to-collision estimation from the filtered LIDAR distance. Closing speed
+ * is estimated from a short history of timestamped distances, and obstacle
+ * alerts are raised on time-to-collision bands instead of a fixed distance so
+ * the warning time is the same at any walking speed.
+ *
+ * Created on December 7, 2024, 2:30 PM
+ */
+
+#ifndef TTC_H
+#define TTC_H
+
+#include <stdint.h>
+
+// Obstacle states returned by ttc_update()
+#define TTC_CLEAR       0   // Nothing to report
+#define TTC_APPROACHING 1   // Collision expected within the alert band
+#define TTC_RECEDING    2   // Object that triggered an alert is moving away
+
+// Interval between samples kept in the history (ms)
+#ifndef TTC_SAMPLE_MS
+#define TTC_SAMPLE_MS 100
+#endif
+
+// Number of history samples, speed is measured across the whole history
+#ifndef TTC_HISTORY
+#define TTC_HISTORY 6
+#endif
+
+// Alert when a collision is expected within this time (ms)
+#ifndef TTC_ALERT_MS
+#define TTC_ALERT_MS 2500
+#endif
+
+// Clear the alert once the time to collision is above this (ms)
+#ifndef TTC_CLEAR_MS
+#define TTC_CLEAR_MS 3500
+#endif
+
+// Report a receding object for up to this long after the last alert (ms)
+#ifndef TTC_RECEDE_HOLD_MS
+#define TTC_RECEDE_HOLD_MS 2000
+#endif
+
+// Closing speeds below this are treated as standing still (cm/s)
+#ifndef TTC_MIN_SPEED
+#define TTC_MIN_SPEED 15
+#endif
+
+// Drop back to TTC_CLEAR after this long without an accepted sample (ms)
+#ifndef TTC_STALE_MS
+#define TTC_STALE_MS 500
+#endif
+
+// Objects closer than this always raise an alert (cm)
+#ifndef TTC_GUARD_DISTANCE
+#define TTC_GUARD_DISTANCE 30
+#endif
+
+// Time to collision reported when not closing in
+#define TTC_INFINITE 0xFFFF
+
+// Estimator state
+typedef struct {
+    uint32_t time[TTC_HISTORY];     // Sample timestamps (ms)
+    uint16_t distance[TTC_HISTORY]; // Sample distances (cm)
+    uint8_t index;                  // Slot of the newest sample
+    uint8_t count;                  // Number of valid samples
+    int16_t speed;                  // Closing speed (cm/s), negative when receding
+    uint16_t ttc;                   // Time to collision (ms) or TTC_INFINITE
+    uint8_t state;                  // TTC_CLEAR, TTC_APPROACHING or TTC_RECEDING
+    uint32_t lastAlert;             // Timestamp of the last TTC_APPROACHING sample, 0 if none (ms)
+    uint32_t lastSample;            // Timestamp of the last sample passed in (ms)
+} ttc_t;
+
+
+/**
+ * @brief Resets the estimator.
+ *
+ * @param ttc Estimator state.
+ */
+void ttc_init(ttc_t *ttc);
+
+/**
+ * @brief Adds a filtered distance sample and updates the obstacle state.
+ *
+ * @param ttc Estimator state.
+ * @param distance Filtered distance in cm.
+ * @param now Timestamp of the LIDAR frame in ms.
+ * @return The obstacle state (TTC_CLEAR, TTC_APPROACHING or TTC_RECEDING).
+ */
+uint8_t ttc_update(ttc_t *ttc, uint16_t distance, uint32_t now);
+
+/**
+ * @brief Clears the obstacle state once samples have stopped arriving.
+ * Turning towards open space gives frames with no usable return, which the
+ * LIDAR filter rejects, so the estimator stops hearing about the object
+ * instead of seeing it move away. Call whenever no new sample is available.
+ *
+ * @param ttc Estimator state.
+ * @param now Current time in ms.
+ * @return 1 if the history was dropped by this call, 0 otherwise.
+ */
+uint8_t ttc_expire(ttc_t *ttc, uint32_t now);
+
+#endif /* TTC_H */
@@ -1,59 +1,118 @@
-/*
- * File:   usart.c
- * Author: chehj
- *
- * Description:
- * Implementation of USART (Universal Synchronous Asynchronous Receiver Transmitter) functions.
- * Includes USART initialization and a function for reading characters from USART.
- *
- * Created on December 1, 2024, 8:45 PM
- */
-
-#include "usart.h"
-
-/**
- * @brief Initializes the USART1 module for communication.
- * Configures the UART pins, sets baud rate, enables RX and TX, and configures
- * other settings like data bits, parity, stop bits, and asynchronous mode.
- */
-void usartInit() {
-    // Configure UART pins:
-    // RX (PIN1) as input
-    PORTC.DIR &= ~PIN1_bm;
-    // TX (PIN0) as output
-    PORTC.DIR |= PIN0_bm;
-    
-    // Initialize the USART baud rate to 115200
-    // USART_BAUD_VALUE macro calculates the correct value based on the desired baud rate
-    USART1.BAUD = USART_BAUD_VALUE(115200);
-    
-    // Enable RX (Receiver) and TX (Transmitter), set RX mode to normal
-    USART1.CTRLB = USART_TXEN_bm | USART_RXEN_bm | USART_RXMODE_NORMAL_gc;
-    
-    // Configure USART frame format:
-    // - 8 data bits
-    // - No parity
-    // - 1 stop bit
-    // - Asynchronous mode
-    USART1.CTRLC = USART_CHSIZE_8BIT_gc | 
-                   USART_PMODE_DISABLED_gc |  // No parity
-                   USART_SBMODE_1BIT_gc |    // 1 stop bit
-                   USART_CMODE_ASYNCHRONOUS_gc;  // Asynchronous mode
-
-    // Enable debug run mode, allowing the USART to run during debugging
-    USART1.DBGCTRL = USART_DBGRUN_bm;
-}
-
-/**
- * @brief Reads a character from the USART1 data register.
- * Waits until data is received and then returns the received character.
- * 
- * @return Received character from USART.
- */
-char usartReadChar() {
-    // Wait until data is available in the USART RX buffer
-    while (!(USART1.STATUS & USART_RXCIF_bm));  // Wait for RXC (Receive Complete) flag
-    
-    // Return the received character from the data register
-    return USART1.RXDATAL;
-}
+/*
+ * File:   usart.c
+ * Author: chehj
+ *
+ * Description:
+ * Implementation of USART (Universal Synchronous Asynchronous Receiver Transmitter) functions.
+ * Includes USART initialization and a function for reading characters from USART.
+ * Received bytes are moved into a ring buffer by the RXC interrupt so that no
+ * data is lost while the main loop is busy.
+ *
+ * Created on December 1, 2024, 8:45 PM
+ */
+
+#include "usart.h"
+
+// Receive ring buffer filled by the RXC interrupt
+static uint8_t rxStorage[USART_RX_BUFFER_SIZE];
+static ring_t rxRing;
+volatile uint16_t usartRxOverflows = 0;
+
+/**
+ * @brief Initializes the USART1 module for communication.
+ * Configures the UART pins, sets baud rate, enables RX and TX, and configures
+ * other settings like data bits, parity, stop bits, and asynchronous mode.
+ */
+void usartInit() {
+    // Configure UART pins:
+    // RX (PIN1) as input
+    PORTC.DIR &= ~PIN1_bm;
+    // TX (PIN0) as output
+    PORTC.DIR |= PIN0_bm;
+    
+    // Initialize the USART baud rate to 115200
+    // USART_BAUD_VALUE macro calculates the correct value based on the desired baud rate
+    USART1.BAUD = USART_BAUD_VALUE(115200);
+    
+    // Reset the receive ring buffer
+    ring_init(&rxRing, rxStorage, USART_RX_BUFFER_SIZE);
+    
+    // Enable RX (Receiver) and TX (Transmitter), set RX mode to normal
+    USART1.CTRLB = USART_TXEN_bm | USART_RXEN_bm | USART_RXMODE_NORMAL_gc;
+    
+    // Configure USART frame format:
+    // - 8 data bits
+    // - No parity
+    // - 1 stop bit
+    // - Asynchronous mode
+    USART1.CTRLC = USART_CHSIZE_8BIT_gc | 
+                   USART_PMODE_DISABLED_gc |  // No parity
+                   USART_SBMODE_1BIT_gc |    // 1 stop bit
+                   USART_CMODE_ASYNCHRONOUS_gc;  // Asynchronous mode
+
+    // Enable debug run mode, allowing the USART to run during debugging
+    USART1.DBGCTRL = USART_DBGRUN_bm;
+    
+    // Enable the Receive Complete interrupt to fill the ring buffer
+    USART1.CTRLA |= USART_RXCIE_bm;
+}
+
+/**
+ * @brief USART1 Receive Complete interrupt.
+ * Moves the received byte into the ring buffer. If the buffer is full the
+ * byte is dropped and counted, so the oldest unread data is preserved.
+ */
+ISR(USART1_RXC_vect) {
+    uint8_t data = USART1.RXDATAL;  // Reading RXDATAL clears the RXC flag
+    
+    if (!ring_push(&rxRing, data)) {
+        usartRxOverflows++;
+    }
+}
+
+/**
+ * @brief Returns the number of bytes waiting in the receive ring buffer.
+ * 
+ * @return Number of unread bytes.
+ */
+uint8_t usartAvailable() {
+    return ring_count(&rxRing);
+}
+
+/**
+ * @brief Reads a character from the receive ring buffer without blocking.
+ * 
+ * @param[out] c Pointer to store the received character.
+ * @return 1 if a character was read, 0 if the buffer is empty.
+ */
+uint8_t usartTryReadChar(uint8_t *c) {
+    return ring_pop(&rxRing, c);
+}
+
+/**
+ * @brief Reads a character from the USART1 receive ring buffer.
+ * Waits until data is received and then returns the received character.
+ * 
+ * @return Received character from USART.
+ */
+char usartReadChar() {
+    uint8_t c;
+    
+    // Wait until the RXC interrupt has stored a byte in the ring buffer
+    while (!usartTryReadChar(&c));
+    
+    return c;
+}
+
+/**
+ * @brief Writes a character to the USART1 TX data register.
+ * Waits until the data register is empty before writing.
+ * 
+ * @param c Character to transmit.
+ */
+void usartWriteChar(uint8_t c) {
+    // Wait for the Data Register Empty flag
+    while (!(USART1.STATUS & USART_DREIF_bm));
+    
+    USART1.TXDATAL = c;
+}
@@ -1,34 +1,72 @@
-/*
- * File:   usart.h
- * Author: chehj
- *
- * Created on December 1, 2024, 8:45 PM
- */
-
-#ifndef USART_H
-#define USART_H
-
-#include <avr/io.h>
-
-#ifndef F_CPU
-#define F_CPU 3333333
-#endif
-
-
-// Macros
-#define SAMPLES_PER_BIT 16
-#define USART_BAUD_VALUE(BAUD_RATE) (uint16_t) ((F_CPU << 6) / (((float) SAMPLES_PER_BIT) * (BAUD_RATE)) + 0.5)
-
-/**
- * @brief Initializes the USART module with predefined settings.
- */
-void usartInit(void);
-
-/**
- * @brief Reads a character from the USART RX buffer.
- * 
- * @return The received character.
- */
-char usartReadChar(void);
-
-#endif /* USART_H */
+/*
+ * File:   usart.h
+ * Author: chehj
+ *
+ * Created on December 1, 2024, 8:45 PM
+ */
+
+#ifndef USART_H
+#define USART_H
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <stdint.h>
+#include "ring.h"
+
+#ifndef F_CPU
+#define F_CPU 3333333
+#endif
+
+
+// Macros
+#define SAMPLES_PER_BIT 16
+#define USART_BAUD_VALUE(BAUD_RATE) (uint16_t) ((F_CPU << 6) / (((float) SAMPLES_PER_BIT) * (BAUD_RATE)) + 0.5)
+
+// Receive ring buffer size, must be a power of two so wrapping is a mask
+// 64 bytes holds ~7 TFMini frames (~5.5 ms of data at 115200 baud)
+#define USART_RX_BUFFER_SIZE 64
+
+#if !RING_SIZE_VALID(USART_RX_BUFFER_SIZE)
+#error "USART_RX_BUFFER_SIZE must be a power of two"
+#endif
+
+// Number of bytes dropped because the ring buffer was full
+extern volatile uint16_t usartRxOverflows;
+
+/**
+ * @brief Initializes the USART module with predefined settings.
+ */
+void usartInit(void);
+
+/**
+ * @brief Reads a character from the USART RX buffer.
+ * Blocks until a byte is available in the receive ring buffer.
+ * 
+ * @return The received character.
+ */
+char usartReadChar(void);
+
+/**
+ * @brief Writes a character to the USART TX data register.
+ * Waits until the data register is empty before writing.
+ * 
+ * @param c Character to transmit.
+ */
+void usartWriteChar(uint8_t c);
+
+/**
+ * @brief Returns the number of bytes waiting in the receive ring buffer.
+ * 
+ * @return Number of unread bytes.
+ */
+uint8_t usartAvailable(void);
+
+/**
+ * @brief Reads a character from the receive ring buffer without blocking.
+ * 
+ * @param[out] c Pointer to store the received character.
+ * @return 1 if a character was read, 0 if the buffer is empty.
+ */
+uint8_t usartTryReadChar(uint8_t *c);
+
+#endif /* USART_H */